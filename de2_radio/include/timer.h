@@ -95,6 +95,9 @@
 /** @brief Stop timer, prescaler 000 --> STOP */
 #define tim2_stop() TCCR2B &= ~((1<<CS22) | (1<<CS21) | (1<<CS20));
 
+/** @brief Set overflow 1ms, prescaler 100 --> 64 */
+#define tim2_ovf_1ms() TCCR2B &= ~((1<<CS21) | (1<<CS20)); TCCR2B |= (1<<CS22);
+
 /** @brief Set overflow 16ms, prescaler // 111 --> 1024 */
 #define tim2_ovf_16ms() TCCR2B |= (1<<CS22) | (1<<CS21) | (1<<CS20);
 
@@ -104,6 +107,15 @@
 /** @brief Disable overflow interrupt, 0 --> disable */
 #define tim2_ovf_disable() TIMSK2 &= ~(1<<TOIE2);
 
+/** @brief Clear timer on compare match with OCR2A (CTC), period = OCR2A+1 ticks */
+#define tim2_ctc_mode() TCCR2A = (1<<WGM21); TCCR2B &= ~(1<<WGM22);
+
+/** @brief Enable compare match A interrupt, 1 --> enable */
+#define tim2_compa_enable() TIMSK2 |= (1<<OCIE2A);
+
+/** @brief Disable compare match A interrupt, 0 --> disable */
+#define tim2_compa_disable() TIMSK2 &= ~(1<<OCIE2A);
+
 
 
 
@@ -1,5 +1,6 @@
 #include "OLED_RDS.h"
 #include "oled.h"
+#include "icons.h"
 #include <util/delay.h>
 #include <stdio.h>
 #include <avr/pgmspace.h>
@@ -10,10 +11,30 @@ OledDisplay::OledDisplay(uint8_t maxChars)
       maxVisibleChars(maxChars),
       scrollPos(0),
       frequency(0),
-      volume(0) 
+      volume(0),
+      rssi(0),
+      stereo(false),
+      clearPending(false)
 {
 }
 
+void OledDisplay::showSplash()
+{
+    oled_drawBitmap_rle(0, 0, rle_splash);
+#ifdef GRAPHICMODE
+    clearPending = true;    // first render() starts from an empty buffer
+#endif
+}
+
+bool OledDisplay::flush()
+{
+#ifdef GRAPHICMODE
+    return oled_display_next();
+#else
+    return false;
+#endif
+}
+
 int OledDisplay::strlen_local(const char* s)
 {
     int len = 0;
@@ -40,6 +61,12 @@ void OledDisplay::setVolume(int vol)
     volume = vol;
 }
 
+void OledDisplay::setSignal(int rssiValue, bool isStereo)
+{
+    rssi = rssiValue;
+    stereo = isStereo;
+}
+
 void OledDisplay::update()
 {
     render();
@@ -51,14 +78,26 @@ void OledDisplay::render()
 {
     char freqBuf[20];
 
+#ifdef GRAPHICMODE
+    // the SPI stream of the last frame reads the buffer, let it finish
+    while (oled_display_busy());
+    if (clearPending) {
+        oled_clear_buffer();
+        clearPending = false;
+    }
+#endif
+
     // Print as float using integer math
-    int mhz = frequency / 100;       // integer part
-    int hundredths = frequency % 100; // fractional part
-    sprintf(freqBuf, "%d.%01d MHz", mhz, hundredths);
+    int mhz = frequency / 100;              // integer part
+    int tenths = (frequency % 100) / 10;    // fractional part (100 kHz steps)
+    sprintf(freqBuf, "%3d.%01d", mhz, tenths);
 
-    oled_charMode(DOUBLESIZE);
+    // Big 12x24 digits on lines 0-2, unit in the normal font beside them
     oled_gotoxy(0, 0);
-    oled_puts(freqBuf);
+    oled_puts_big(freqBuf);
+    oled_charMode(NORMALSIZE);
+    oled_gotoxy(5 * BIGDIGIT_WIDTH / 6 + 1, 2);
+    oled_puts("MHz");
 
     // RDS text area
     oled_charMode(NORMALSIZE);
@@ -80,7 +119,13 @@ void OledDisplay::render()
     sprintf(volBuf, "VOL: %02d/15", volume);
     oled_puts(volBuf);
 
-#ifdef GRAPHICMODE
-    oled_display();
-#endif
+    // Signal bars (RSSI in dBuV, 10 dB per bar) and stereo indicator
+    static const uint8_t* const signalIcons[] = {
+        rle_signal_0, rle_signal_1, rle_signal_2, rle_signal_3, rle_signal_4
+    };
+    int bars = rssi / 10;
+    if (bars > 4) bars = 4;
+    oled_drawBitmap_rle(104, 6, signalIcons[bars]);
+    oled_drawBitmap_rle(116, 6, stereo ? rle_stereo : rle_mono);
+    // flush() sends only the spans that changed since the last frame
 }
@@ -12,10 +12,18 @@ public:
     void setRdsText(const char* text);
     void setFrequency(int freq);
     void setVolume(int vol);
+    void setSignal(int rssiValue, bool isStereo);  // RSSI (dBuV) and stereo indicator
 
-    // Call periodically (e.g., every 100 ms)
+    // Boot logo into the buffer, stays until the first update()
+    void showSplash();
+
+    // Call periodically (e.g., every 100 ms), draws into the buffer
     void update();
 
+    // Send the next changed page of the buffer (one at most, ~12 ms on
+    // I2C at 100 kHz); true while more are left
+    bool flush();
+
 private:
     int strlen_local(const char* s);
     void render();
@@ -28,6 +36,9 @@ private:
     int scrollPos;
     int frequency;
     int volume;
+    int rssi;
+    bool stereo;
+    bool clearPending;
 };
 
 #endif
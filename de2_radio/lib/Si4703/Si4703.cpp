@@ -5,18 +5,15 @@
 
 
 #include "Si4703.h"
-#include "gpio.h"
 #include <util/delay.h>
 #include "twi.h"
+#include "log.h"
 
 Si4703 radio;
 //-----------------------------------------------------------------------------------------------------------------------------------
 // Si4703 Class Initialization
 //-----------------------------------------------------------------------------------------------------------------------------------
 Si4703::Si4703(
-    int rstPin,
-    int sdioPin,
-    int sclkPin,
     int intPin,
     int band,
     int space,
@@ -30,9 +27,6 @@ Si4703::Si4703(
 
 {
   // MCU Pins Selection
-  _rstPin   = rstPin;   // Reset Pin
-  _sdioPin  = sdioPin;  // I2C Data IO Pin
-  _sclkPin  = sclkPin;  // I2C Clock Pin
   _intPin   = intPin;   // Seek/Tune Complete Pin
 
   // Band Settings
@@ -55,7 +49,7 @@ Si4703::Si4703(
 // Read the entire register set (0x00 - 0x0F) to Shadow
 // Reading is in following register address sequence 0A,0B,0C,0D,0E,0F,00,01,02,03,04,05,06,07,08,09 = 16 Words = 32 bytes.
 //-----------------------------------------------------------------------------------------------------------------------------------
-void Si4703::getShadow()
+void Si4703::getShadow(uint8_t words)
 {
     // Adresa Slave zařízení posunuta o 1 bit doleva pro R/W bit (1=READ)
     uint8_t slave_read_addr = (I2C_ADDR << 1) | TWI_READ; 
@@ -67,15 +61,16 @@ void Si4703::getShadow()
         return;
     }
     
-    // Čtení 32 bytů (16 dvouslovných registrů)
-    for(int i = 0 ; i < 16; i++) {
+    // Čtení 32 bytů (16 dvouslovných registrů), or only the first words
+    // (0x0A STATUSRSSI, 0x0B READCHAN) when polling
+    for(int i = 0 ; i < words; i++) {
         uint8_t msb, lsb;
 
         // Čtení MSB (Všechny kromě 32. bytu dostávají ACK)
         msb = twi_read(TWI_ACK);
 
         // Čtení LSB
-        if (i < 15) {
+        if (i < words - 1) {
             // LSB 1. až 15. slova dostanou ACK, aby Slave poslal další byte
             lsb = twi_read(TWI_ACK);
         } else {
@@ -93,8 +88,9 @@ void Si4703::getShadow()
 //-----------------------------------------------------------------------------------------------------------------------------------
 // Write the current 9 control registers (0x02 to 0x07) to the Si4703
 // The Si4703 assumes you are writing to 0x02 first, then increments
+// (words = 2 writes only POWERCFG and CHANNEL, 5 bytes on the bus)
 //-----------------------------------------------------------------------------------------------------------------------------------
-uint8_t Si4703::putShadow()
+uint8_t Si4703::putShadow(uint8_t words)
 {
     // Adresa Slave zařízení (I2C_ADDR) posunuta o 1 bit doleva pro R/W bit
     // TWI_WRITE (0) je R/W bit nastavený na zápis
@@ -115,7 +111,7 @@ uint8_t Si4703::putShadow()
     }
 
     // 3. Odeslat 6 dvouslovných registrů (12 bytů)
-    for(int i = 8 ; i < 14; i++) { 
+    for(int i = 8 ; i < 8 + words; i++) { 
         
         // Zápis Horního bytu (Upper byte)
         uint8_t upper_byte = shadow.word[i] >> 8;
@@ -153,44 +149,53 @@ void	Si4703::bus3Wire(void)
 //-----------------------------------------------------------------------------------------------------------------------------------
 void	Si4703::bus2Wire(void)		
 {
-  // Set IO pins directions
-  gpio_mode_output(&DDRD, _rstPin);    // Reset pin
-  gpio_mode_output(&DDRC, _sdioPin);   // I2C data IO pin
-  
-  // Set communcation mode to 2-Wire
-  gpio_write_low(&PORTD, _rstPin);   // Put Si4703 into reset
-  gpio_write_low(&PORTC, _sdioPin);  // A low SDIO indicates a 2-wire interface
+  bootReset();                      // Reset with SDIO low selects 2-wire mode
   _delay_ms(1);                     // Delay to allow pins to settle
-  gpio_write_high(&PORTD, _rstPin);  // Bring Si4703 out of reset with SDIO set to low and SEN pulled high with on-board resistor
+  bootRelease();                    // Bring Si4703 out of reset
   _delay_ms(1);                     // Allow Si4703 to come out of reset
   twi_init();                // Now that the unit is reset and I2C inteface mode, we need to begin I2C
 
 }	
 //-----------------------------------------------------------------------------------------------------------------------------------
+// 2-wire mode selection in steps, each 1 ms apart (bus2Wire() without the delays)
+//-----------------------------------------------------------------------------------------------------------------------------------
+void	Si4703::bootReset(void)
+{
+  // Set IO pins directions
+  RstPin::output();                 // Reset pin
+  SdioPin::output();                // I2C data IO pin
+  
+  // Set communcation mode to 2-Wire
+  RstPin::low();                    // Put Si4703 into reset
+  SdioPin::low();                   // A low SDIO indicates a 2-wire interface
+}
+
+void	Si4703::bootRelease(void)
+{
+  RstPin::high();                   // Bring Si4703 out of reset with SDIO set to low and SEN pulled high with on-board resistor
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
 // Power Up Device
 //-----------------------------------------------------------------------------------------------------------------------------------
 void Si4703::powerUp()
 {
-  // Enable Oscillator
-  getShadow();                            // Read the current register set
-  shadow.reg.TEST1.bits.XOSCEN = 1;       // Enable the oscillator
-  putShadow();                            // Write to registers
-  _delay_ms(500);                             // Wait for oscillator to settle
-
-  // Enable Device
-  getShadow();                            // Read the current register set
-  shadow.reg.POWERCFG.bits.ENABLE   = 1;  // Powerup Enable=1
-  
-  shadow.reg.POWERCFG.bits.DISABLE  = 0;  // Powerup Disable=0
-  shadow.reg.POWERCFG.bits.DMUTE    = 1;  // Disable Mute
-  
-  putShadow();                            // Write to registers
-  _delay_ms(110);                             // wait for max power up time
+  startOscillator();                          // Enable the oscillator
+  _delay_ms(XOSC_SETTLE_MS);                  // Wait for oscillator to settle
+  enable();                                   // Powerup Enable
+  _delay_ms(POWERUP_MS);                      // wait for max power up time
 }
 //-----------------------------------------------------------------------------------------------------------------------------------
 // Power Down
 //-----------------------------------------------------------------------------------------------------------------------------------
 void Si4703::powerDown()
+{
+  disable();                                  // Start power down
+  _delay_ms(2);                                   // wait for max power down time
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Power Down without waiting; the chip is off 2 ms later
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703::disable()
 {
   getShadow();                                // Read the current register set
   shadow.reg.TEST1.bits.AHIZEN      = 1;      // LOUT/LOUT = High impedance
@@ -204,7 +209,6 @@ void Si4703::powerDown()
   shadow.reg.POWERCFG.bits.DISABLE  = 1;      // PowerDown Disable=1
   
   putShadow();                                // Write to registers
-  _delay_ms(2);                                   // wait for max power down time
 }
 //-----------------------------------------------------------------------------------------------------------------------------------
 // To get the Si4703 in to 2-wire mode, SEN needs to be high and SDIO needs to be low after a reset
@@ -218,7 +222,73 @@ void Si4703::start()
 
   // Default Start Configuration
   getShadow();                            // Read the current register set
+  configure();                            // Default settings into the shadow
+  putShadow();                                      // Write to registers
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Cold boot in steps, so the caller can do its own work while the chip waits:
+//   bootReset()                      reset, SDIO low for 2-wire mode
+//   ... 1 ms ...
+//   bootRelease()                    out of reset
+//   ... 1 ms ...
+//   bootBegin()                      I2C up, crystal on
+//   ... XOSC_SETTLE_MS later ...
+//   enable()                         power up
+//   ... POWERUP_MS later ...
+//   bootConfigure(freq, volume, mono) configure and start the tune in one write
+//   pollOp() until it returns the frequency
+// Replaces start() and powers the chip up exactly once.
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703::bootBegin()
+{
+  twi_init();                             // The unit is in 2-wire mode now
+  startOscillator();                      // Enable the oscillator, no wait
+}
+
+void Si4703::bootConfigure(int freq, int volume, bool mono)
+{
+  getShadow();                                // Read the current register set
+  configure();                                // Default settings, sets the band limits
+
+  if (freq > _bandEnd)    freq = _bandEnd;    // check upper limit
+  if (freq < _bandStart)  freq = _bandStart;  // check lower limit
+  if (volume < 0 ) volume = 0;                // Accepted Volume value 0-15
+  if (volume > 15) volume = 15;               // Accepted Volume value 0-15
 
+  shadow.reg.SYSCONFIG2.bits.VOLUME = volume; // Restored volume
+  shadow.reg.POWERCFG.bits.MONO     = mono;   // Restored mono
+  shadow.reg.CHANNEL.bits.CHAN  = (freq - _bandStart) / _bandSpacing;
+  shadow.reg.CHANNEL.bits.TUNE  = 1;          // Set the TUNE bit to start
+  putShadow();                                // Write to registers
+  _op = OP_TUNE;
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Enable the crystal oscillator (first half of power up)
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703::startOscillator()
+{
+  getShadow();                            // Read the current register set
+  shadow.reg.TEST1.bits.XOSCEN = 1;       // Enable the oscillator
+  putShadow();                            // Write to registers
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Enable the device (second half of power up), needs a settled oscillator
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703::enable()
+{
+  getShadow();                            // Read the current register set
+  shadow.reg.POWERCFG.bits.ENABLE   = 1;  // Powerup Enable=1
+  
+  shadow.reg.POWERCFG.bits.DISABLE  = 0;  // Powerup Disable=0
+  shadow.reg.POWERCFG.bits.DMUTE    = 1;  // Disable Mute
+  
+  putShadow();                            // Write to registers
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Default start configuration into the shadow registers (no bus access)
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703::configure()
+{
   // Select region band
   setRegion(_band,_space,_de);                      // Select region band limits
   shadow.reg.SYSCONFIG2.bits.SPACE  = _space;       // Select Channel Spacing Type
@@ -259,7 +329,6 @@ void Si4703::start()
   shadow.reg.SYSCONFIG1.bits.GPIO2  = GPIO_Z;       // GPIO2 = High impedance (default)
   shadow.reg.SYSCONFIG1.bits.GPIO3  = GPIO_Z;       // GPIO3 = High impedance (default)
   
-  putShadow();                                      // Write to registers
 }
 //-----------------------------------------------------------------------------------------------------------------------------------
 // Set FM Band Region limits and spacing
@@ -412,6 +481,7 @@ int Si4703::setChannel(int freq)
 {
   if (freq > _bandEnd)    freq = _bandEnd;    // check upper limit
   if (freq < _bandStart)  freq = _bandStart;  // check lower limit
+  LOG_DEBUG("tune %u", freq);
 
   // Freq     = Spacing * Channel + bandStart.
   // Channel  = (Freq - bandStart) / Spacing
@@ -420,6 +490,13 @@ int Si4703::setChannel(int freq)
   shadow.reg.CHANNEL.bits.TUNE  = 1;        // Set the TUNE bit to start
   putShadow();                              // Write to registers
 
+  return finishTune();
+}
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Wait for the tune started by the TUNE bit, then clear it
+//-----------------------------------------------------------------------------------------------------------------------------------
+int Si4703::finishTune()
+{
   if (shadow.reg.SYSCONFIG1.bits.STCIEN == 0) // Select method Interrupt or STC
     while(!getSTC());                         // Wait for the si4703 to set the STC
   else
@@ -534,6 +611,169 @@ int Si4703::seekDown()
     return result;
 }
 
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Non-blocking tune and seek. Start one, then call pollOp() every few ms
+// until it returns non-zero. Each poll reads only STATUSRSSI and READCHAN.
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703::tuneStart(int freq)
+{
+  if (freq > _bandEnd)    freq = _bandEnd;    // check upper limit
+  if (freq < _bandStart)  freq = _bandStart;  // check lower limit
+  LOG_DEBUG("tune %u", freq);
+
+  getShadow();                              // Read the current register set
+  shadow.reg.CHANNEL.bits.CHAN  = (freq - _bandStart) / _bandSpacing;
+  shadow.reg.CHANNEL.bits.TUNE  = 1;        // Set the TUNE bit to start
+  putShadow();                              // Write to registers
+  _op = OP_TUNE;
+}
+
+void Si4703::seekStart(bool up)
+{
+  _seekUp = up;
+  _seekWrapped = false;
+  startSeek();
+}
+
+void Si4703::startSeek()
+{
+  getShadow();                                      // Read the current register set
+  shadow.reg.POWERCFG.bits.SEEKUP = _seekUp;        // Seek direction = UP/Down
+  shadow.reg.POWERCFG.bits.SEEK   = 1;              // Start seek
+  putShadow();                                      // Write to registers to start seeking
+  _op = OP_SEEK;
+}
+
+int Si4703::pollOp()
+{
+  switch (_op)
+  {
+    case OP_TUNE:
+    case OP_SEEK:
+    case OP_WRAP:
+      getShadow(2);                                 // STATUSRSSI and READCHAN only
+      if (!shadow.reg.STATUSRSSI.bits.STC) return 0;
+
+      _opFailed = (_op == OP_SEEK) && shadow.reg.STATUSRSSI.bits.SFBL;
+      _opWrap = (_op == OP_WRAP);
+      getShadow();                                  // Read the current register set
+      shadow.reg.CHANNEL.bits.TUNE  = 0;            // Clear Tune bit
+      shadow.reg.POWERCFG.bits.SEEK = 0;            // Stop seek
+      putShadow();                                  // Write to registers
+      _op = OP_CLEAR;
+      return 0;
+
+    case OP_CLEAR:
+      getShadow(2);
+      if (shadow.reg.STATUSRSSI.bits.STC) return 0; // Wait for the si4703 to clear the STC
+      _op = OP_IDLE;
+
+      if (_opWrap) {
+        // at the band edge now, seek again from there
+        startSeek();
+        return 0;
+      }
+      if (_opFailed) {
+        if (!_seekWrapped) {
+          // band limit or nothing found: jump to the other edge once
+          _seekWrapped = true;
+          int edge = _seekUp ? _bandStart : _bandEnd;
+          getShadow();
+          shadow.reg.CHANNEL.bits.CHAN  = (edge - _bandStart) / _bandSpacing;
+          shadow.reg.CHANNEL.bits.TUNE  = 1;
+          putShadow();
+          _op = OP_WRAP;
+          return 0;
+        }
+        return -1;
+      }
+      return (_bandSpacing * shadow.reg.READCHAN.bits.READCHAN + _bandStart);
+
+    case OP_SCAN:
+      getShadow(2);                                 // STATUSRSSI and READCHAN only
+      if (!shadow.reg.STATUSRSSI.bits.STC) return 0;
+
+      // RSSI is valid as soon as STC is set, no extra settle time
+      _scanMap[_scanChan] = lastSignal();
+      _scanChan++;
+      shadow.reg.CHANNEL.bits.TUNE = 0;             // Clear Tune bit
+      putShadow(2);                                 // POWERCFG and CHANNEL only
+      _op = OP_SCAN_CLEAR;
+      return 0;
+
+    case OP_SCAN_CLEAR:
+      getShadow(2);
+      if (shadow.reg.STATUSRSSI.bits.STC) return 0; // Wait for the si4703 to clear the STC
+      if (_scanChan < _scanCount) {
+        shadow.reg.CHANNEL.bits.CHAN = _scanFirst + _scanChan;
+        _op = OP_SCAN;
+      }
+      else {
+        shadow.reg.CHANNEL.bits.CHAN = _scanHome;   // done, still muted
+        _op = OP_SCAN_HOME;
+      }
+      shadow.reg.CHANNEL.bits.TUNE = 1;
+      putShadow(2);
+      return 0;
+
+    case OP_SCAN_HOME:
+      getShadow(2);
+      if (!shadow.reg.STATUSRSSI.bits.STC) return 0;
+      shadow.reg.CHANNEL.bits.TUNE = 0;
+      shadow.reg.POWERCFG.bits.DMUTE = _scanDmute;  // audio back on the home channel
+      putShadow(2);
+      _opFailed = false;
+      _opWrap = false;
+      _op = OP_CLEAR;                               // returns the home frequency
+      return 0;
+
+    default:
+      return 0;
+  }
+}
+
+// Signal of the channel the last poll saw, no bus access
+uint8_t Si4703::lastSignal() const
+{
+  return (shadow.reg.STATUSRSSI.bits.RSSI & SCAN_RSSI) |
+         (shadow.reg.STATUSRSSI.bits.ST ? SCAN_STEREO : 0);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------
+// Band scan: one tune per channel, each step writes only POWERCFG and
+// CHANNEL and polls only STATUSRSSI and READCHAN. Audio is muted meanwhile
+// and comes back only once the home channel is tuned.
+//-----------------------------------------------------------------------------------------------------------------------------------
+void Si4703::scanStart(uint8_t *map, uint16_t first, uint16_t count, int home)
+{
+  uint16_t channels = getChannelCount();
+  if (first >= channels) first = channels - 1;
+  if (count > channels - first) count = channels - first;
+  if (home > _bandEnd)    home = _bandEnd;      // check upper limit
+  if (home < _bandStart)  home = _bandStart;    // check lower limit
+
+  _scanMap    = map;
+  _scanFirst  = first;
+  _scanCount  = count;
+  _scanChan   = 0;
+  _scanHome   = (home - _bandStart) / _bandSpacing;
+
+  getShadow();                                      // Read the current register set
+  _scanDmute  = shadow.reg.POWERCFG.bits.DMUTE;
+  shadow.reg.POWERCFG.bits.DMUTE = 0;               // DMUTE = 0 mutes
+  shadow.reg.CHANNEL.bits.CHAN   = count ? first : _scanHome;
+  shadow.reg.CHANNEL.bits.TUNE   = 1;
+  putShadow(2);
+  _op = count ? OP_SCAN : OP_SCAN_HOME;
+}
+
+void Si4703::scanAbort()
+{
+  // measuring: this one is the last; between two: home next
+  if (_op == OP_SCAN && _scanChan < _scanCount) _scanCount = _scanChan + 1;
+  if (_op == OP_SCAN_CLEAR) _scanCount = _scanChan;
+}
+
 
 //-----------------------------------------------------------------------------------------------------------------------------------
 // Get Sterio current value
@@ -550,6 +790,35 @@ bool Si4703::getST(void)
 // Čtení RDS textu (PS nebo RadioText) do bufferu
 // buffer musí být dostatečně velký (např. 65 znaků pro RadioText + '\0')
 
+// Status and raw RDS group: STATUSRSSI..RDSD only (12 bytes), no decoding
+void Si4703::getStatus(Status &status)
+{
+  getShadow(6);
+  status.rssi     = shadow.reg.STATUSRSSI.bits.RSSI;
+  status.stereo   = shadow.reg.STATUSRSSI.bits.ST;
+  status.rdsSync  = shadow.reg.STATUSRSSI.bits.RDSS;
+  status.afcRail  = shadow.reg.STATUSRSSI.bits.AFCRL;
+  status.rdsReady = shadow.reg.STATUSRSSI.bits.RDSR;
+  status.channel  = shadow.reg.READCHAN.bits.READCHAN;
+  status.rds[0]   = shadow.reg.RDSA.word;
+  status.rds[1]   = shadow.reg.RDSB.word;
+  status.rds[2]   = shadow.reg.RDSC.word;
+  status.rds[3]   = shadow.reg.RDSD.word;
+  status.bler     = (shadow.reg.STATUSRSSI.bits.BLERA << 6) |
+                    (shadow.reg.READCHAN.bits.BLERB << 4) |
+                    (shadow.reg.READCHAN.bits.BLERC << 2) |
+                     shadow.reg.READCHAN.bits.BLERD;
+}
+
+bool Si4703::getRDSGroup(uint16_t blocks[4], uint8_t &errors)
+{
+  Status status;
+  getStatus(status);
+  for (uint8_t i = 0; i < 4; i++) blocks[i] = status.rds[i];
+  errors = status.bler;
+  return status.rdsReady;
+}
+
 
 
 
@@ -642,6 +911,11 @@ int	Si4703::getBandSpace()
 {
   return(_bandSpacing);
 }
+
+int	Si4703::getChannelCount()
+{
+  return((_bandEnd - _bandStart) / _bandSpacing + 1);
+}
 //-----------------------------------------------------------------------------------------------------------------------------------
 // Get RSSI current value
 //-----------------------------------------------------------------------------------------------------------------------------------
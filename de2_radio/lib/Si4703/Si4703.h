@@ -9,7 +9,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
-#include "gpio.h"
+#include "pin.h"
 
 
 
@@ -80,10 +80,7 @@ class Si4703
 //------------------------------------------------------------------------------------------------------------
   public:
     Si4703(	                
-				// MCU Pins Selection
-                int rstPin    = PD4,            // Reset Pin
-			    int sdioPin   = PC4,           // I2C Data IO Pin
-			    int sclkPin   = PC5,           // I2C Clock Pin
+				// MCU Pins Selection (RST and SDIO are RstPin/SdioPin below)
 			    int intPin    = 0,	          // Seek/Tune Complete and RDS interrupt Pin
 
 
@@ -108,6 +105,40 @@ class Si4703
 	void	powerDown();				// Power Down radio device to save power
 	void 	start();				// start radio
 
+	// Cold boot in steps (see Si4703.cpp), the caller times the waits
+	static const uint16_t XOSC_SETTLE_MS	= 500;	// Crystal settle time after bootBegin()
+	static const uint16_t POWERUP_MS		= 110;	// Max power up time after enable()
+	void	bootReset();			// Reset with SDIO low (2-wire mode select)
+	void	bootRelease();			// Out of reset, 1 ms after bootReset()
+	void	bootBegin();			// I2C up and crystal on, 1 ms after bootRelease()
+	void	enable();				// Power up the device, oscillator must have settled
+	void	disable();				// Power down the device, no wait
+	void	bootConfigure(int freq,	// Configure, restore volume/mono and start the tune in one write
+					 int volume,
+					 bool mono);
+
+	// Non-blocking tune and seek, finished by calling pollOp() every few ms
+	void	tuneStart(int freq);	// Start tuning a frequency
+	void	seekStart(bool up);		// Start a seek, wraps once at the band edge
+	bool	busy(void) const { return _op != OP_IDLE; }
+	int		pollOp(void);			// 0 while running, tuned freq when done, -1 seek found nothing
+
+	// Band scan, also finished by pollOp(): tunes a run of channels once,
+	// muted, stores RSSI (bits 6:0) and stereo (bit 7) in one byte per
+	// channel, then tunes home and restores the mute state. pollOp()
+	// returns the home frequency.
+	static const uint8_t SCAN_STEREO	= 0x80;
+	static const uint8_t SCAN_RSSI		= 0x7f;
+	void	scanStart(uint8_t *map,	// Receives channel 'first' in map[0]
+					  uint16_t first,	// Channel index, 0 = band start
+					  uint16_t count,	// Channels to scan, clipped at the band end
+					  int home);		// Frequency to tune at the end
+	void	scanAbort(void);		// Stop after the channel being tuned, then home
+	bool	scanning(void) const { return _op >= OP_SCAN; }
+	uint16_t scanCount(void) const { return _scanCount; }	// Channels of the scan
+	uint16_t scanDone(void) const { return _scanChan; }		// Channels measured so far
+	uint8_t	lastSignal(void) const;	// Scan map byte of the channel the last pollOp() read
+
 	int		getPN();				// Get DeviceID:Part Number
 	int		getMFGID();				// Get DeviceID:Manufacturer ID
 	int		getREV();				// Get ChipID:Chip Version
@@ -117,6 +148,7 @@ class Si4703
 	int		getBandStart();			// Get Band Start Frequency
 	int		getBandEnd();			// Get Band End Frequency
 	int		getBandSpace();			// Get Band Spacing
+	int		getChannelCount();		// Channels from band start to end
 
 	int		getRSSI(void);			// Get RSSI current value
 
@@ -142,6 +174,20 @@ class Si4703
 	int		decVolume(void);		// Decrement Volume
 
 	void	readRDS(char* buffer, long timeout);			// Reads RDS, message should be at least 9 chars, result will be null terminated.
+	bool	getRDSGroup(uint16_t blocks[4],	// Raw blocks A-D, true if a new group is ready
+					uint8_t &errors);	// BLERA-D, 2 bits each, A in the top bits
+
+	struct Status {				// Registers 0x0A-0x0F, read in one go
+		uint8_t		rssi;
+		bool		stereo;
+		bool		rdsSync;
+		bool		afcRail;
+		bool		rdsReady;		// rds[] holds a new group
+		uint16_t	channel;		// READCHAN
+		uint16_t	rds[4];			// Blocks A-D
+		uint8_t		bler;			// BLERA-D, 2 bits each, A in the top bits
+	};
+	void	getStatus(Status &status);	// 12 byte read instead of 32
 
 	void	writeGPIO(int GPIO, 	// Write to GPIO1,GPIO2, and GPIO3
 					  int val); 	// values can be GPIO_Z, GPIO_I, GPIO_Low, and GPIO_High
@@ -149,9 +195,8 @@ class Si4703
 //------------------------------------------------------------------------------------------------------------
   private:
     // MCU Pins Selection
-	int _rstPin;				// Reset Pin
-	int _sdioPin;				// I2C Data IO Pin
-	int _sclkPin;				// I2C Clock Pin
+	typedef Pin<PortD, 4> RstPin;	// Reset Pin
+	typedef Pin<PortC, 4> SdioPin;	// I2C Data IO Pin (SCLK is PC5, driven by the TWI)
 	int _intPin;				// Seek/Tune Complete and RDS interrupt Pin
 
 	// Band Settings
@@ -173,9 +218,23 @@ class Si4703
 	int _sksnr;					// Seek Signal/Noise Ratio
 	int _agcd;					// AGC disable
 
+	// Non-blocking operation in progress
+	enum { OP_IDLE, OP_TUNE, OP_SEEK, OP_WRAP, OP_CLEAR, OP_SCAN, OP_SCAN_CLEAR, OP_SCAN_HOME };
+	uint8_t _op = OP_IDLE;		// Operation waiting for STC
+	bool	_seekUp = true;		// Seek direction
+	bool	_seekWrapped = false;	// Already jumped to the other band edge
+	bool	_opFailed = false;	// Seek ended with SFBL
+	bool	_opWrap = false;	// Finished step was the jump to the band edge
+	uint8_t	*_scanMap = nullptr;	// Band scan results
+	uint16_t _scanFirst = 0;	// Channel of _scanMap[0]
+	uint16_t _scanCount = 0;	// Channels to scan
+	uint16_t _scanChan = 0;		// Channel being tuned, = measured so far
+	uint16_t _scanHome = 0;		// Channel to return to
+	bool	_scanDmute = false;	// DMUTE to restore after the scan
+
 	// Private Functions
-	void	getShadow();		// Read registers to shadow 
-	byte 	putShadow();		// Write shadow to registers
+	void	getShadow(uint8_t words = 16);	// Read registers to shadow (from 0x0A)
+	byte 	putShadow(uint8_t words = 6);	// Write shadow to registers (from 0x02)
 	void	bus3Wire(void);		// 3-Wire Control Interface (SCLK, SEN, SDIO)
 	void	bus2Wire(void);		// 2-Wire Control Interface (SCLCK, SDIO)
 	void	setRegion(int band,	// Band Range
@@ -183,6 +242,10 @@ class Si4703
 					  int de);	// De-Emphasis
 	bool	getSTC(void);		// Get STC status
 	int 	seek(byte seekDir);	// Seek next channel
+	void	startSeek(void);	// Start a seek in _seekUp direction
+	void	startOscillator();	// Enable the crystal oscillator
+	void	configure();		// Default start configuration into the shadow
+	int		finishTune();		// Wait for STC after TUNE, clear TUNE
 
 	// I2C interface
 	static const int  		I2C_ADDR		= 0x10; // I2C address of Si4703 - note that the Wire function assumes non-left-shifted I2C address, not 0b.0010.000W
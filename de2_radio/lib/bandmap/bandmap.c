@@ -0,0 +1,157 @@
+/*
+ * Band map: one byte of RSSI and stereo per channel from a band scan.
+ */
+
+// -- Includes -------------------------------------------------------
+#include <stddef.h>
+#include <bandmap.h>
+#include <systick.h>
+
+
+// -- Local variables ------------------------------------------------
+static uint8_t map[BANDMAP_CHANNELS];
+static uint8_t valid;
+static uint32_t oldestAt;       // every entry is at least this recent
+static uint32_t sweepAt;        // start of the running refresh sweep
+static uint8_t cursor;          // next channel of the sweep
+static uint16_t sweeps;
+static uint16_t refreshed;
+
+
+// -- Local functions ------------------------------------------------
+static uint8_t rssi(uint8_t ch)
+{
+    return map[ch] & BANDMAP_RSSI;
+}
+
+
+// -- Function definitions -------------------------------------------
+uint8_t *bandmap_data(void)
+{
+    return map;
+}
+
+
+void bandmap_scanned(void)
+{
+    valid = 1;
+    oldestAt = sweepAt = millis();
+    cursor = 0;
+}
+
+
+uint8_t bandmap_valid(void)
+{
+    return valid;
+}
+
+
+uint8_t bandmap_fresh(void)
+{
+    return valid && millis() - oldestAt < BANDMAP_MAX_AGE_MS;
+}
+
+
+void bandmap_update(uint8_t ch, uint8_t signal)
+{
+    if (ch < BANDMAP_CHANNELS) map[ch] = signal;
+}
+
+
+uint8_t bandmap_next(uint8_t ch, uint8_t up)
+{
+    if (ch >= BANDMAP_CHANNELS) ch = up ? BANDMAP_CHANNELS - 1 : 0;
+
+    for (uint8_t i = 1; i < BANDMAP_CHANNELS; i++) {
+        if (up) ch = (ch + 1 == BANDMAP_CHANNELS) ? 0 : ch + 1;
+        else ch = (ch == 0) ? BANDMAP_CHANNELS - 1 : ch - 1;
+        if (bandmap_is_station(ch)) return ch;
+    }
+    return BANDMAP_NONE;
+}
+
+
+uint8_t bandmap_is_station(uint8_t ch)
+{
+    if (ch >= BANDMAP_CHANNELS) return 0;
+    uint8_t level = rssi(ch);
+
+    // ties go to the lower channel
+    if (level < BANDMAP_STATION_RSSI) return 0;
+    if (ch > 0 && rssi(ch - 1) >= level) return 0;
+    if (ch + 1 < BANDMAP_CHANNELS && rssi(ch + 1) > level) return 0;
+    return 1;
+}
+
+
+uint8_t bandmap_stations(uint8_t *channels, uint8_t max)
+{
+    uint8_t total = 0;
+    uint8_t cutoff = BANDMAP_STATION_RSSI;  // listed from this RSSI up
+    uint8_t spare = 0xff;                   // of those exactly at cutoff
+
+    for (uint8_t ch = 0; ch < BANDMAP_CHANNELS; ch++)
+        total += bandmap_is_station(ch);
+    if (channels == NULL) return total;
+
+    if (total > max) {
+        // raise the cutoff until no more than max stations are above it,
+        // the ones exactly at it fill the rest in band order
+        uint8_t above;
+        do {
+            cutoff++;
+            above = 0;
+            for (uint8_t ch = 0; ch < BANDMAP_CHANNELS; ch++)
+                if (rssi(ch) > cutoff && bandmap_is_station(ch)) above++;
+        } while (above > max);
+        spare = max - above;
+    }
+
+    uint8_t n = 0;
+    for (uint8_t ch = 0; ch < BANDMAP_CHANNELS; ch++) {
+        if (!bandmap_is_station(ch) || rssi(ch) < cutoff) continue;
+        if (rssi(ch) == cutoff) {
+            if (!spare) continue;
+            spare--;
+        }
+        channels[n++] = ch;
+    }
+    return n;
+}
+
+
+uint8_t bandmap_refresh_next(void)
+{
+    return cursor;
+}
+
+
+void bandmap_refresh_store(uint8_t signal)
+{
+    if (valid) {
+        uint8_t level = (rssi(cursor) + (signal & BANDMAP_RSSI) + 1) >> 1;
+        signal = (signal & BANDMAP_STEREO) | level;
+    }
+    map[cursor] = signal;
+    refreshed++;
+
+    if (++cursor == BANDMAP_CHANNELS) {
+        // all entries are now from this sweep or newer
+        cursor = 0;
+        sweeps++;
+        valid = 1;
+        oldestAt = sweepAt;
+        sweepAt = millis();
+    }
+}
+
+
+void bandmap_get_stats(bandmap_stats_t *stats)
+{
+    uint32_t age = (millis() - oldestAt) / 1000;
+
+    stats->ageS = !valid ? 0xffff : (age > 0xfffe ? 0xfffe : age);
+    stats->sweepPct = (uint16_t)cursor * 100 / BANDMAP_CHANNELS;
+    stats->sweeps = sweeps;
+    stats->refreshed = refreshed;
+}
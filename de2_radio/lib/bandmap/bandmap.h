@@ -0,0 +1,153 @@
+#ifndef BANDMAP_H
+# define BANDMAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @defgroup bandmap Band map <bandmap.h>
+ * @code #include <bandmap.h> @endcode
+ *
+ * @brief RSSI and stereo of every channel of the band, one byte each.
+ *
+ * Filled by a band scan (Si4703::scanStart() writes straight into
+ * bandmap_data()); channels are numbered like the presets, channel 0 is
+ * PRESET_BAND_START. A channel counts as a station when its RSSI reaches
+ * BANDMAP_STATION_RSSI and is a local maximum, so the spill-over of a
+ * strong transmitter into the neighbouring channels is not listed.
+ *
+ * Between scans the map is refreshed a few channels at a time, in band
+ * order from a cursor (bandmap_refresh_next()/bandmap_refresh_store()).
+ * A refreshed entry is the mean of the old and the new RSSI, so a station
+ * that went away fades out over two sweeps rather than on one bad sample.
+ * A sweep that completes makes the map valid even without a scan.
+ *
+ * The age of the map is the age of its oldest entry: since the start of
+ * the previous sweep or the last scan. A map older than BANDMAP_MAX_AGE_MS
+ * is stale: good enough to list, but a seek should not trust it any more.
+ * @{
+ */
+
+// -- Includes -------------------------------------------------------
+#include <stdint.h>
+#include <presets.h>
+
+
+// -- Defines --------------------------------------------------------
+#define BANDMAP_CHANNELS     206    /**< @brief 87.5-108.0 MHz in 100 kHz steps */
+#define BANDMAP_RSSI        0x7f    /**< @brief RSSI in dBuV, bits 6:0 */
+#define BANDMAP_STEREO      0x80    /**< @brief Stereo pilot seen */
+#define BANDMAP_STATION_RSSI  25    /**< @brief Weakest RSSI listed as a station */
+#define BANDMAP_MAX_AGE_MS 3600000UL /**< @brief Scan age after which the map is stale */
+#define BANDMAP_NONE        0xff    /**< @brief No channel */
+
+
+// -- Types ----------------------------------------------------------
+/** @brief Freshness, see bandmap_get_stats() */
+typedef struct {
+    uint16_t ageS;      /**< @brief Age of the oldest entry in s, 0xffff if not valid */
+    uint8_t sweepPct;   /**< @brief Progress of the running refresh sweep */
+    uint16_t sweeps;    /**< @brief Refresh sweeps completed since boot */
+    uint16_t refreshed; /**< @brief Channels refreshed since boot */
+} bandmap_stats_t;
+
+
+// -- Function prototypes --------------------------------------------
+/**
+ * @brief  The map, BANDMAP_CHANNELS bytes, to scan into.
+ * @return Pointer to channel 0
+ */
+uint8_t *bandmap_data(void);
+
+
+/**
+ * @brief  Mark the map as filled by a complete scan just now.
+ * @return none
+ */
+void bandmap_scanned(void);
+
+
+/**
+ * @brief  A complete scan has been stored since boot.
+ * @return 1 if valid
+ */
+uint8_t bandmap_valid(void);
+
+
+/**
+ * @brief  The map is valid and younger than BANDMAP_MAX_AGE_MS.
+ * @return 1 if fresh
+ */
+uint8_t bandmap_fresh(void);
+
+
+/**
+ * @brief  Store a new measurement of one channel, e.g. after a tune.
+ * @param  ch Channel index
+ * @param  signal RSSI and BANDMAP_STEREO, like a scan entry
+ * @return none
+ */
+void bandmap_update(uint8_t ch, uint8_t signal);
+
+
+/**
+ * @brief  Next station above or below a channel, wrapping at the band
+ *         edges.
+ * @param  ch Channel to start from (not itself a candidate)
+ * @param  up Non-zero to search upwards
+ * @return Channel index, BANDMAP_NONE if the map holds no other station
+ */
+uint8_t bandmap_next(uint8_t ch, uint8_t up);
+
+
+/**
+ * @brief  Channel the refresh sweep measures next; channels after it up to
+ *         the band end follow in order.
+ * @return Channel index
+ */
+uint8_t bandmap_refresh_next(void);
+
+
+/**
+ * @brief  Store the measurement of bandmap_refresh_next() and move on.
+ * @param  signal RSSI and BANDMAP_STEREO, like a scan entry
+ * @return none
+ */
+void bandmap_refresh_store(uint8_t signal);
+
+
+/**
+ * @brief  Age and refresh progress of the map.
+ * @param  stats Filled with the current values
+ * @return none
+ */
+void bandmap_get_stats(bandmap_stats_t *stats);
+
+
+/**
+ * @brief  Channel is a station: strong enough and a local maximum.
+ * @param  ch Channel index
+ * @return 1 if it is
+ */
+uint8_t bandmap_is_station(uint8_t ch);
+
+
+/**
+ * @brief  List the stations in band order. If there are more than max,
+ *         the strongest max are listed.
+ * @param  channels Receives the channel bytes (preset format), or NULL
+ *         to count only
+ * @param  max Size of channels
+ * @return Number of stations listed (all of them when counting)
+ */
+uint8_t bandmap_stations(uint8_t *channels, uint8_t max);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,9 +1,4 @@
-#include "FreqSelector.h"
+#include "freqselector.h"
 
 FreqSelector* FreqSelector::instance = nullptr;
-
-// ISR for PORTD pin change (PCINT2 group)
-ISR(PCINT2_vect)
-{
-    FreqSelector::handleInterrupt();
-}
\ No newline at end of file
+constexpr int8_t FreqSelector::quadTable[16];
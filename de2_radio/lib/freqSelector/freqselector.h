@@ -3,29 +3,41 @@
 
 #include <avr/io.h>
 #include <avr/interrupt.h>
-#include <gpio.h>
+#include <log.h>
+#include <pin.h>
+#include <presets.h>
 #include <stdint.h>
+#include <systick.h>
+
+// Front panel wiring: NEXT button / encoder A, PREV button / encoder B
+typedef Pin<PortD, 6> FreqPinA;
+typedef Pin<PortD, 5> FreqPinB;
 
 class FreqSelector {
 public:
-    FreqSelector(const int* freqArray,
-                 uint8_t size,
-                 uint8_t pinNext_in,
-                 uint8_t pinPrev_in)
-        : freqs(freqArray),
-          freqCount(size),
-          pinNext(pinNext_in),
-          pinPrev(pinPrev_in)
+    // Preset mode: steps through the EEPROM preset list (presets_init()
+    // must have run before the first get()). The buttons are sampled and
+    // debounced by the input module, the main loop calls next()/prev().
+    FreqSelector()
+        : presetMode(true),
+          freqCount(0)
     {
-        portReg = &PIND;
-
-        // Input pullups
-        gpio_mode_input_pullup(&DDRD, pinNext);
-        gpio_mode_input_pullup(&DDRD, pinPrev);
+    }
 
-        lastNext = gpio_read(portReg, pinNext);
-        lastPrev = gpio_read(portReg, pinPrev);
+    // Rotary encoder on FreqPinA/FreqPinB: tunes the whole band in spacing
+    // steps, fast turns move several channels per detent
+    FreqSelector(int bandStart_in,
+                 int bandEnd_in,
+                 int spacing_in)
+        : presetMode(false),
+          freqCount((bandEnd_in - bandStart_in) / spacing_in + 1),
+          bandStart(bandStart_in),
+          spacing(spacing_in)
+    {
+        FreqPinA::inputPullup();
+        FreqPinB::inputPullup();
 
+        quadState = readAB();
         setupPCINT();
     }
 
@@ -33,64 +45,136 @@ public:
         instance = inst;
     }
 
-    int get() const {
-        return freqs[index_pos];
+    // Preset mode: step to the next/previous preset (wraps around).
+    // The list can change at runtime, so the count is read every time.
+    void next() {
+        uint8_t count = presets_count();
+        if (count) index_pos = (index_pos + 1 >= count) ? 0 : index_pos + 1;
+        reload();
     }
 
-    // ISR entry point
-    static void handleInterrupt() {
-        if (instance) instance->updateISR();
+    void prev() {
+        uint8_t count = presets_count();
+        if (count) index_pos = (index_pos == 0 || index_pos > count) ? count - 1 : index_pos - 1;
+        reload();
     }
 
-private:
-    const int* freqs;
-    uint8_t freqCount;
+    // Jump to a preset (e.g. one that was just saved) or, in encoder
+    // mode, to a channel of the band
+    void select(uint8_t index) {
+        if (index < count()) index_pos = index;
+        if (presetMode) reload();
+    }
+
+    // Preset mode: re-read the selected preset after the list changed.
+    // get() runs every loop pass and must not touch the EEPROM.
+    void reload() {
+        uint8_t count = presets_count();
+        if (count && index_pos >= count) index_pos = count - 1;
+        presetFreq = presets_get(index_pos);
+    }
+
+    uint8_t index() const {
+        return index_pos;
+    }
 
-    uint8_t pinNext;
-    uint8_t pinPrev;
+    // Number of presets, or of channels in encoder mode
+    uint8_t count() const {
+        return presetMode ? presets_count() : freqCount;
+    }
 
-    volatile uint8_t* portReg;
+    int get() const {
+        if (presetMode) return presetFreq;
+        return bandStart + index_pos * spacing;
+    }
 
-    volatile int8_t index_pos = 0;
+    // Pin change handler for the PCINT dispatcher (FreqPinA/FreqPinB)
+    static void pinChange(uint8_t changed, uint8_t pins) {
+        (void)changed;
+        if (instance && !instance->presetMode) instance->updateEncoderISR(pins);
+    }
 
-    volatile uint8_t lastNext;
-    volatile uint8_t lastPrev;
+private:
+    bool presetMode;
+    int presetFreq = 0;             // preset mode: frequency at index_pos
+    uint8_t freqCount;              // encoder mode: channels in the band
+
+    volatile uint8_t index_pos = 0;
+
+    // Encoder mode
+    int bandStart = 0;
+    int spacing = 0;
+    uint8_t quadState = 0;          // previous AB in bits 1:0
+    int8_t quadSteps = 0;           // valid transitions since last detent
+    uint32_t lastDetent = 0;        // millis() at the last detent
+
+    // Gray code transition table, index = (previous AB << 2) | AB.
+    // Invalid jumps (both bits changed) and bounce count as 0 or cancel out.
+    static constexpr int8_t quadTable[16] = {
+         0, -1,  1,  0,
+         1,  0,  0, -1,
+        -1,  0,  0,  1,
+         0,  1, -1,  0
+    };
+    static constexpr int8_t stepsPerDetent = 4;
+
+    // Channels per detent by time since the previous detent:
+    // < 15 ms -> 10, < 30 ms -> 5, < 60 ms -> 2, slower -> 1.
+    // 20 detents of a quick spin sweep the 205 channels of 87.5-108 MHz.
+    // The 32-bit ms clock does not wrap, so a long pause is always slow.
+    static uint8_t accel(uint32_t ms) {
+        if (ms < 15) return 10;
+        if (ms < 30) return 5;
+        if (ms < 60) return 2;
+        return 1;
+    }
 
     static FreqSelector* instance;
 
-    volatile uint8_t debounceNext = 0;
-    volatile uint8_t debouncePrev = 0;
-    static constexpr uint8_t debounceMask = 3; // ignore 5 PCINT events
-
     // ------------------------------------
     // Setup PCINT for PORTD (PCINT16–23)
     // ------------------------------------
     void setupPCINT() {
         PCICR  |= (1 << PCIE2);         // Enable PCINT group 2
-        PCMSK2 |= (1 << pinNext);       // Enable PCINT for NEXT button
-        PCMSK2 |= (1 << pinPrev);       // Enable PCINT for PREVIOUS button
+        PCMSK2 |= FreqPinA::mask;       // Enable PCINT for encoder A
+        PCMSK2 |= FreqPinB::mask;       // Enable PCINT for encoder B
         sei();
     }
 
-    void updateISR() {
-    uint8_t n = gpio_read(portReg, pinNext);
-    uint8_t p = gpio_read(portReg, pinPrev);
-
-    if (debounceNext) debounceNext--;
-    if (debouncePrev) debouncePrev--;
-
-    if (n == 0 && lastNext == 1 && debounceNext == 0) {
-        index_pos = (index_pos + 1) % freqCount;
-        debounceNext = debounceMask;
+    // two sbic/sbis instead of a pointer load and two shift loops
+    static uint8_t readAB() {
+        uint8_t ab = 0;
+        if (FreqPinA::read()) ab |= 2;
+        if (FreqPinB::read()) ab |= 1;
+        return ab;
     }
 
-    if (p == 0 && lastPrev == 1 && debouncePrev == 0) {
-        index_pos = (index_pos == 0 ? freqCount - 1 : index_pos - 1);
-        debouncePrev = debounceMask;
+    // same from the PIND snapshot taken by the dispatcher
+    static uint8_t snapshotAB(uint8_t pins) {
+        uint8_t ab = 0;
+        if (pins & FreqPinA::mask) ab |= 2;
+        if (pins & FreqPinB::mask) ab |= 1;
+        return ab;
     }
 
-    lastNext = n;
-    lastPrev = p;
+    void updateEncoderISR(uint8_t pins) {
+        uint8_t ab = snapshotAB(pins);
+        quadState = ((quadState << 2) | ab) & 0x0f;
+        quadSteps += quadTable[quadState];
+
+        if (quadSteps >= stepsPerDetent || quadSteps <= -stepsPerDetent) {
+            uint32_t now = millis();
+            uint8_t step = accel(now - lastDetent);
+            lastDetent = now;
+
+            int16_t pos = index_pos;
+            pos += (quadSteps > 0) ? step : -step;
+            if (pos < 0) pos = 0;
+            if (pos > freqCount - 1) pos = freqCount - 1;
+            index_pos = pos;
+            quadSteps = 0;
+            LOG_DEBUG("encoder %u step %u", pos, step);
+        }
     }
 
 };
@@ -0,0 +1,62 @@
+#ifndef PIN_H
+#define PIN_H
+
+/*
+ * Compile-time GPIO pins for C++ code.
+ *
+ *   typedef Pin<PortD, 4> RstPin;
+ *   RstPin::output();
+ *   RstPin::low();
+ *   if (RstPin::read()) ...
+ *
+ * Port and bit are template parameters and the register addresses are
+ * constants, so every operation compiles to a single sbi, cbi, sbic or
+ * sbis instruction (PINx/DDRx/PORTx of the ATmega328P sit in the low I/O
+ * space). Use the C functions in gpio.h where the pin is only known at
+ * run time.
+ */
+
+#include <stdint.h>
+#ifndef __AVR__
+# include <hal_native.h>
+#endif
+
+// Register at a data space address; the host build keeps the I/O space in
+// an array (hal.h) and brings a PINx cell up to date before it is read
+static inline volatile uint8_t& io_reg(uint8_t addr) {
+#ifdef __AVR__
+    return *reinterpret_cast<volatile uint8_t*>(addr);
+#else
+    if (addr == 0x23 || addr == 0x26 || addr == 0x29) return *hal_native_pinx(addr);
+    return hal_io[addr];
+#endif
+}
+
+// Data space addresses of the ATmega328P port registers
+struct PortB { static constexpr uint8_t pin = 0x23, ddr = 0x24, port = 0x25; };
+struct PortC { static constexpr uint8_t pin = 0x26, ddr = 0x27, port = 0x28; };
+struct PortD { static constexpr uint8_t pin = 0x29, ddr = 0x2A, port = 0x2B; };
+
+template <class Port, uint8_t N>
+struct Pin {
+    static_assert(N < 8, "pin number must be 0 to 7");
+
+    static constexpr uint8_t bit = N;
+    static constexpr uint8_t mask = 1 << N;
+
+    static void output()      { reg(Port::ddr) |= mask; }
+    static void input()       { reg(Port::ddr) &= ~mask; reg(Port::port) &= ~mask; }
+    static void inputPullup() { reg(Port::ddr) &= ~mask; reg(Port::port) |= mask; }
+
+    static void high()        { reg(Port::port) |= mask; }
+    static void low()         { reg(Port::port) &= ~mask; }
+    static void toggle()      { reg(Port::pin) |= mask; }   // writing 1 to PINx toggles
+    static void write(bool v) { if (v) high(); else low(); }
+
+    static bool read()        { return reg(Port::pin) & mask; }
+
+private:
+    static volatile uint8_t& reg(uint8_t addr) { return io_reg(addr); }
+};
+
+#endif
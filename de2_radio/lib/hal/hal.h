@@ -0,0 +1,109 @@
+#ifndef HAL_H
+# define HAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @defgroup hal Hardware abstraction <hal.h>
+ * @code #include <hal.h> @endcode
+ *
+ * @brief The few hardware accesses that differ between the AVR build and
+ *        the host (native) build.
+ *
+ * The firmware stays written against the ATmega328P. Each peripheral has
+ * one owner module, whose API is the abstraction:
+ *
+ *   | Peripheral | Interface         | Host build                            |
+ *   |------------|-------------------|---------------------------------------|
+ *   | TWI        | twi.h             | bus of simulated devices              |
+ *   | GPIO       | pin.h, gpio.h     | port registers, pins driven by a test |
+ *   | Timers     | systick.h         | Timer1 and Timer2 on a virtual clock  |
+ *   | UART       | uart.h            | USART on stdin/stdout                 |
+ *   | EEPROM     | avr/eeprom.h, hal | array, optionally a file              |
+ *   | Sleep      | power.h           | virtual time skips to the next event  |
+ *
+ * On the host, lib/hal/native provides avr/io.h and the other avr-libc
+ * headers: the I/O registers are an array, ISR() defines a plain function,
+ * and hal_native.c models Timer1, Timer2, the USART, the EEPROM, the
+ * watchdog, pin changes and sleep on a virtual CPU clock, calling the
+ * vectors as the interrupt controller would. Only the TWI master, whose
+ * register handshake cannot be modelled by memory cells, is replaced at
+ * the twi.h level. Code runs in zero virtual time; time passes while the
+ * MCU sleeps, waits in a delay or a busy loop, or moves bytes over the
+ * TWI, so a run is deterministic and bus costs are exact.
+ *
+ * What remains here are the accesses the host cannot model as registers:
+ * busy-wait loops, which must let virtual time pass, and EEPROM reads and
+ * writes that complete while an interrupt routine runs.
+ * @{
+ */
+
+// -- Includes -------------------------------------------------------
+#include <stdint.h>
+#ifdef __AVR__
+# include <avr/io.h>
+#else
+# include <hal_native.h>
+#endif
+
+
+// -- Function definitions -------------------------------------------
+#ifdef __AVR__
+
+/**
+ * @brief  Body of a loop that waits for an interrupt or a peripheral.
+ *         Nothing on the AVR; on the host virtual time moves to the next
+ *         event.
+ * @return none
+ */
+static inline void hal_spin(void) {}
+
+
+/**
+ * @brief  Read an EEPROM byte. The EEPROM must be ready (no write in
+ *         progress), as in the EE_READY interrupt.
+ * @param  addr EEPROM address
+ * @return Byte
+ */
+static inline uint8_t hal_ee_read(uint16_t addr)
+{
+    EEAR = addr;
+    EECR |= (1 << EERE);
+    return EEDR;
+}
+
+
+/**
+ * @brief  Start an erase and write of an EEPROM byte (3.4 ms). The EEPROM
+ *         must be ready and the call not interrupted between the two
+ *         EECR writes, as in the EE_READY interrupt.
+ * @param  addr EEPROM address
+ * @param  value Byte to write
+ * @return none
+ */
+static inline void hal_ee_write(uint16_t addr, uint8_t value)
+{
+    EEAR = addr;
+    EEDR = value;
+    EECR |= (1 << EEMPE);
+    EECR |= (1 << EEPE);
+}
+
+#else
+
+# define hal_spin       hal_native_spin
+# define hal_ee_read    hal_native_ee_read
+# define hal_ee_write   hal_native_ee_write
+
+#endif
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
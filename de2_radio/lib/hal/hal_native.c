@@ -0,0 +1,783 @@
+/*
+ * Host build of the HAL: ATmega328P peripherals on a virtual cycle clock,
+ * see hal_native.h. Not part of the AVR build.
+ */
+
+#ifndef __AVR__
+
+// -- Includes -------------------------------------------------------
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <avr/io.h>
+#include <avr/sleep.h>
+#include <hal_native.h>
+
+
+// -- Defines --------------------------------------------------------
+#ifndef F_CPU
+# define F_CPU 16000000UL
+#endif
+
+#define NEVER           UINT64_MAX
+#define AWAKE           0xff                        // sleepMode while running
+#define EE_WRITE_CYCLES (F_CPU / 10000 * 34)        // 3.4 ms erase and write
+#define WDT_CYCLES      (F_CPU / 1000 * 16)         // 2048 cycles of 128 kHz
+#define SLEEP_MODE_MASK (_BV(SM0) | _BV(SM1) | _BV(SM2))
+#define WAKE_PRESS      (F_CPU / 10)                // 100 ms HAL_WAKE press
+
+
+// -- Types ----------------------------------------------------------
+typedef void (*vector_t)(void);
+
+
+// -- Global variables -----------------------------------------------
+volatile uint8_t hal_io[0x100] __attribute__((aligned(2)));
+
+
+// -- Local variables ------------------------------------------------
+void hal_vector_3(void) __attribute__((weak));     // PCINT0
+void hal_vector_4(void) __attribute__((weak));     // PCINT1
+void hal_vector_5(void) __attribute__((weak));     // PCINT2
+void hal_vector_6(void) __attribute__((weak));     // WDT
+void hal_vector_7(void) __attribute__((weak));     // TIMER2_COMPA
+void hal_vector_9(void) __attribute__((weak));     // TIMER2_OVF
+void hal_vector_13(void) __attribute__((weak));    // TIMER1_OVF
+void hal_vector_18(void) __attribute__((weak));    // USART_RX
+void hal_vector_19(void) __attribute__((weak));    // USART_UDRE
+void hal_vector_20(void) __attribute__((weak));    // USART_TX
+void hal_vector_22(void) __attribute__((weak));    // EE_READY
+
+static uint64_t now;                    // CPU cycles since start
+static uint64_t runUntil = NEVER;       // HAL_RUN_MS
+static uint8_t realtime;                // HAL_REALTIME
+static struct timespec wallStart;
+static volatile sig_atomic_t stopRequested;
+static uint8_t sleepMode = AWAKE;
+static uint8_t dispatching;
+static uint32_t vectorsRun;
+static void (*sleepHook)(uint8_t mode);
+
+static uint32_t t1Phase, t2Phase;       // cycles into the current prescaler period
+
+static uint8_t wdtSeen;                 // WDTCSR setup the period was armed with
+static uint64_t wdtAt = NEVER;
+
+static uint64_t udrFreeAt;              // transmit data register empty again
+static uint64_t lineFreeAt;             // shift register done
+static uint64_t txcAt = NEVER;
+static uint64_t rxAt;                   // earliest next received byte
+static uint8_t rxEof;
+
+static const char *eepromFile;          // HAL_EEPROM
+static uint8_t eeprom[E2END + 1];
+static uint64_t eeReadyAt;
+
+static uint8_t extMask[3], extLevel[3]; // pins driven from outside
+static uint8_t wakePort = 0xff;         // HAL_WAKE: pin pressed in power-down
+static uint8_t wakeMask;
+static uint64_t wakeAfter;
+static uint64_t wakeAt = NEVER, wakeReleaseAt = NEVER;
+static uint8_t pinLast[3];              // PINx of the previous update
+static uint8_t pcifrRaised;             // PCIFR flags set by the model
+static const uint8_t pinAddr[3] = { 0x23, 0x26, 0x29 };
+static const uint8_t pcmskAddr[3] = { 0x6B, 0x6C, 0x6D };
+
+static const hal_native_twi_device_t *twiDevices[HAL_NATIVE_TWI_DEVICES];
+static uint8_t twiCount;
+static const hal_native_twi_device_t *twiSlave;    // addressed slave
+static uint8_t twiRead;                 // it was addressed for reading
+static uint8_t twiAddressing;           // the next byte is SLA+R/W
+
+
+// -- Function definitions -------------------------------------------
+/*
+ * Timers: the TCNT registers are the counter state, so firmware writes
+ * to them take effect. Both stop in the sleep modes below ADC noise
+ * reduction, as Timer2 does without an external crystal.
+ */
+static uint8_t clocks_running(void)
+{
+    return sleepMode == AWAKE || sleepMode == SLEEP_MODE_IDLE ||
+           sleepMode == SLEEP_MODE_ADC;
+}
+
+
+static uint16_t t1_prescale(void)
+{
+    static const uint16_t div[8] = { 0, 1, 8, 64, 256, 1024, 0, 0 };
+    return div[TCCR1B & 0x07];          // 6, 7: external clock, never ticks
+}
+
+
+static uint16_t t2_prescale(void)
+{
+    static const uint16_t div[8] = { 0, 1, 8, 32, 64, 128, 256, 1024 };
+    return div[TCCR2B & 0x07];
+}
+
+
+static uint8_t t2_top(void)
+{
+    uint8_t wgm = (TCCR2A & (_BV(WGM21) | _BV(WGM20))) | ((TCCR2B & _BV(WGM22)) ? 4 : 0);
+    return wgm == 2 ? OCR2A : 0xff;     // CTC, anything else counts to 0xff
+}
+
+
+// Cycles until the next Timer2 flag: both OCF2A and TOV2 are set by the
+// timer clock that moves the counter on from OCR2A or 0xff
+static uint64_t t2_next(void)
+{
+    uint16_t div = t2_prescale();
+    if (!div) return NEVER;
+
+    uint8_t top = t2_top();
+    uint8_t count = TCNT2;
+    uint16_t period = top + 1;
+    uint16_t steps = (uint16_t)(OCR2A + period - count) % period + 1;
+    if (top == 0xff && (uint16_t)(0x100 - count) < steps) steps = 0x100 - count;
+    return (uint64_t)steps * div - t2Phase;
+}
+
+
+static void t2_step(uint64_t cycles)
+{
+    uint16_t div = t2_prescale();
+    if (!div) return;
+
+    uint64_t total = t2Phase + cycles;
+    uint64_t counts = total / div;
+    uint8_t top = t2_top();
+    t2Phase = total % div;
+
+    while (counts--) {
+        uint8_t count = TCNT2;
+        if (count == OCR2A) TIFR2 |= _BV(OCF2A);
+        if (count == 0xff) TIFR2 |= _BV(TOV2);
+        TCNT2 = count == top ? 0 : count + 1;
+    }
+}
+
+
+// Cycles until TCNT1 overflows, only needed as an event with its interrupt on
+static uint64_t t1_next(void)
+{
+    uint16_t div = t1_prescale();
+    if (!div || !(TIMSK1 & _BV(TOIE1))) return NEVER;
+    return (0x10000UL - TCNT1) * (uint64_t)div - t1Phase;
+}
+
+
+static void t1_step(uint64_t cycles)
+{
+    uint16_t div = t1_prescale();
+    if (!div) return;
+
+    uint64_t total = t1Phase + cycles;
+    uint64_t counts = TCNT1 + total / div;
+    t1Phase = total % div;
+    if (counts > 0xffff) TIFR1 |= _BV(TOV1);
+    TCNT1 = (uint16_t)counts;
+}
+
+
+/*
+ * Watchdog: (re)armed whenever its WDTCSR setup changes, wdt_reset()
+ * restarts the period.
+ */
+static uint64_t wdt_period(void)
+{
+    uint8_t wdp = (WDTCSR & 0x07) | ((WDTCSR & _BV(WDP3)) ? 0x08 : 0);
+    return (uint64_t)WDT_CYCLES << (wdp > 9 ? 9 : wdp);
+}
+
+
+static void wdt_update(void)
+{
+    uint8_t setup = WDTCSR & ~(_BV(WDIF) | _BV(WDCE));
+
+    if (setup != wdtSeen) {
+        wdtSeen = setup;
+        wdtAt = (setup & (_BV(WDE) | _BV(WDIE))) ? now + wdt_period() : NEVER;
+    }
+    if (wdtAt > now) return;
+
+    if (WDTCSR & _BV(WDIE)) {
+        WDTCSR |= _BV(WDIF);
+        wdtAt += wdt_period();
+    }
+    else {
+        fprintf(stderr, "hal: watchdog reset\n");
+        exit(2);
+    }
+}
+
+
+/*
+ * USART0: one byte in the data register and one in the shift register,
+ * 10 bit frames at the UBRR0 rate.
+ */
+static uint64_t usart_frame(void)
+{
+    uint32_t div = (UCSR0A & _BV(U2X0)) ? 8 : 16;
+    return 10ULL * div * ((UBRR0 & 0x0fff) + 1);
+}
+
+
+static void usart_transmit(uint8_t data)
+{
+    uint64_t start = lineFreeAt > now ? lineFreeAt : now;
+
+    putchar(data);
+    lineFreeAt = start + usart_frame();
+    udrFreeAt = start;
+    txcAt = lineFreeAt;
+    UCSR0A &= ~_BV(TXC0);
+}
+
+
+static void usart_update(void)
+{
+    // UDRE0 is read-only on the AVR, keep it right after firmware writes
+    if (udrFreeAt <= now) UCSR0A |= _BV(UDRE0);
+    else UCSR0A &= ~_BV(UDRE0);
+
+    if (txcAt <= now) {
+        UCSR0A |= _BV(TXC0);
+        txcAt = NEVER;
+    }
+
+    if (!(UCSR0B & _BV(RXEN0)) || (UCSR0A & _BV(RXC0)) || rxEof || rxAt > now)
+        return;
+
+    struct pollfd fd = { .fd = STDIN_FILENO, .events = POLLIN };
+    uint8_t data;
+    if (poll(&fd, 1, 0) <= 0) return;
+    if (read(STDIN_FILENO, &data, 1) != 1) {
+        rxEof = 1;
+        return;
+    }
+    UDR0 = data;
+    UCSR0A |= _BV(RXC0);
+    rxAt = now + usart_frame();
+}
+
+
+/*
+ * Pins: outputs read back what they drive, inputs the outside level or
+ * else their PORTx bit (pull-up on or floating low). Changes on PCMSKx
+ * pins set the PCIFR flag of the port. Writing a one clears a flag on
+ * the AVR; a flag the model did not raise was written by the firmware.
+ */
+static void pins_update(void)
+{
+    PCIFR &= pcifrRaised;
+
+    for (uint8_t p = 0; p < 3; p++) {
+        uint8_t ddr = hal_io[pinAddr[p] + 1];
+        uint8_t port = hal_io[pinAddr[p] + 2];
+        uint8_t in = (extMask[p] & extLevel[p]) | (~extMask[p] & port);
+        uint8_t pin = (ddr & port) | (~ddr & in);
+
+        if ((pin ^ pinLast[p]) & hal_io[pcmskAddr[p]]) PCIFR |= _BV(p);
+        pinLast[p] = pin;
+        hal_io[pinAddr[p]] = pin;
+    }
+    pcifrRaised = PCIFR;
+}
+
+
+/*
+ * HAL_WAKE: a button held low for 100 ms, wakeAfter into a power-down.
+ */
+static void wake_update(void)
+{
+    if (wakeAt <= now) {
+        wakeAt = NEVER;
+        wakeReleaseAt = now + WAKE_PRESS;
+        extMask[wakePort] |= wakeMask;
+        extLevel[wakePort] &= ~wakeMask;
+    }
+    if (wakeReleaseAt <= now) {
+        wakeReleaseAt = NEVER;
+        extMask[wakePort] &= ~wakeMask;
+    }
+}
+
+
+static void io_sync(void)
+{
+    pins_update();
+    usart_update();
+}
+
+
+static void run_vector(vector_t vector)
+{
+    SREG &= ~_BV(SREG_I);
+    vector();
+    SREG |= _BV(SREG_I);
+    vectorsRun++;
+}
+
+
+// Highest priority pending interrupt, returns 0 if there was none
+static uint8_t dispatch_one(void)
+{
+    static const vector_t pcint[3] = { hal_vector_3, hal_vector_4, hal_vector_5 };
+
+    for (uint8_t p = 0; p < 3; p++) {
+        if ((PCICR & _BV(p)) && (PCIFR & _BV(p))) {
+            PCIFR &= ~_BV(p);
+            pcifrRaised &= ~_BV(p);
+            if (pcint[p]) run_vector(pcint[p]);
+            return 1;
+        }
+    }
+    if ((WDTCSR & _BV(WDIE)) && (WDTCSR & _BV(WDIF))) {
+        WDTCSR &= ~_BV(WDIF);
+        if (WDTCSR & _BV(WDE)) WDTCSR &= ~_BV(WDIE);   // next timeout resets
+        if (hal_vector_6) run_vector(hal_vector_6);
+        return 1;
+    }
+    if ((TIMSK2 & _BV(OCIE2A)) && (TIFR2 & _BV(OCF2A))) {
+        TIFR2 &= ~_BV(OCF2A);
+        if (hal_vector_7) run_vector(hal_vector_7);
+        return 1;
+    }
+    if ((TIMSK2 & _BV(TOIE2)) && (TIFR2 & _BV(TOV2))) {
+        TIFR2 &= ~_BV(TOV2);
+        if (hal_vector_9) run_vector(hal_vector_9);
+        return 1;
+    }
+    if ((TIMSK1 & _BV(TOIE1)) && (TIFR1 & _BV(TOV1))) {
+        TIFR1 &= ~_BV(TOV1);
+        if (hal_vector_13) run_vector(hal_vector_13);
+        return 1;
+    }
+    if ((UCSR0B & _BV(RXCIE0)) && (UCSR0A & _BV(RXC0)) && hal_vector_18) {
+        run_vector(hal_vector_18);
+        UCSR0A &= ~_BV(RXC0);           // the ISR has read UDR0
+        return 1;
+    }
+    if ((UCSR0B & _BV(UDRIE0)) && (UCSR0A & _BV(UDRE0)) && hal_vector_19) {
+        run_vector(hal_vector_19);
+        // the ISR either wrote UDR0 or, with nothing left, turned itself off
+        if (UCSR0B & _BV(UDRIE0)) usart_transmit(UDR0);
+        usart_update();
+        return 1;
+    }
+    if ((UCSR0B & _BV(TXCIE0)) && (UCSR0A & _BV(TXC0))) {
+        UCSR0A &= ~_BV(TXC0);
+        if (hal_vector_20) run_vector(hal_vector_20);
+        return 1;
+    }
+    if ((EECR & _BV(EERIE)) && eeReadyAt <= now && hal_vector_22) {
+        run_vector(hal_vector_22);
+        return 1;
+    }
+    return 0;
+}
+
+
+static void dispatch(void)
+{
+    if (!(SREG & _BV(SREG_I)) || dispatching) return;
+    dispatching = 1;
+    do io_sync(); while (dispatch_one());
+    dispatching = 0;
+}
+
+
+static uint64_t next_event(void)
+{
+    uint64_t t = NEVER, e;
+
+#define EARLIER(at) do { e = (at); if (e < t) t = e; } while (0)
+    if (clocks_running()) {
+        EARLIER(t2_next() == NEVER ? NEVER : now + t2_next());
+        EARLIER(t1_next() == NEVER ? NEVER : now + t1_next());
+        if ((UCSR0B & _BV(UDRIE0)) && udrFreeAt > now) EARLIER(udrFreeAt);
+        EARLIER(txcAt);
+    }
+    EARLIER(wdtAt);
+    if (eeReadyAt > now) EARLIER(eeReadyAt);
+    EARLIER(wakeAt);
+    EARLIER(wakeReleaseAt);
+#undef EARLIER
+    return t;
+}
+
+
+// Keep virtual time from running ahead of the wall clock
+static void pace(void)
+{
+    struct timespec wall;
+    clock_gettime(CLOCK_MONOTONIC, &wall);
+
+    int64_t wallUs = (int64_t)(wall.tv_sec - wallStart.tv_sec) * 1000000 +
+                     (wall.tv_nsec - wallStart.tv_nsec) / 1000;
+    int64_t aheadUs = (int64_t)(now / (F_CPU / 1000000)) - wallUs;
+    if (aheadUs > 0) {
+        fflush(stdout);
+        struct timespec ts = { aheadUs / 1000000, aheadUs % 1000000 * 1000 };
+        nanosleep(&ts, NULL);
+    }
+}
+
+
+static void step(uint64_t cycles)
+{
+    if (clocks_running()) {
+        t1_step(cycles);
+        t2_step(cycles);
+    }
+    now += cycles;
+    wdt_update();
+    wake_update();
+    io_sync();
+
+    if (now >= runUntil || stopRequested) exit(0);
+    if (realtime) pace();
+}
+
+
+static void run_to(uint64_t until)
+{
+    while (now < until) {
+        uint64_t t = next_event();
+        if (t > until) t = until;
+        step(t - now);
+        dispatch();
+    }
+}
+
+
+uint64_t hal_native_cycles(void)
+{
+    return now;
+}
+
+
+void hal_native_advance(uint64_t cycles)
+{
+    run_to(now + cycles);
+}
+
+
+void hal_native_spin(void)
+{
+    uint64_t t = next_event();
+
+    if (t == NEVER) {
+        fprintf(stderr, "hal: busy wait with nothing that could end it\n");
+        exit(1);
+    }
+    run_to(t);
+}
+
+
+void hal_native_sleep(void)
+{
+    uint32_t vectors = vectorsRun;
+
+    fflush(stdout);
+    wdt_update();           // set up since the last step, e.g. just before
+    if (sleepHook) sleepHook(SMCR & SLEEP_MODE_MASK);
+    sleepMode = SMCR & SLEEP_MODE_MASK;
+    if (!clocks_running() && wakePort != 0xff) {
+        // once per power-down, the watchdog wakeups sleep again
+        if (wakeAt == NEVER && wakeReleaseAt == NEVER) wakeAt = now + wakeAfter;
+    }
+    else if (!clocks_running() && !sleepHook) {
+        fprintf(stderr, "hal: power-down without a sleep hook or HAL_WAKE, nothing can wake the MCU\n");
+        exit(0);
+    }
+
+    // an interrupt that is already pending wakes at once
+    dispatch();
+    while (vectorsRun == vectors) {
+        uint64_t t = next_event();
+        if (t == NEVER) {
+            fprintf(stderr, "hal: asleep with no wakeup source\n");
+            exit(0);
+        }
+        step(t - now);
+        if (!(SREG & _BV(SREG_I))) break;       // wakes, the ISR runs after sei()
+        dispatch();
+    }
+    sleepMode = AWAKE;
+}
+
+
+void hal_native_set_sleep_hook(void (*hook)(uint8_t mode))
+{
+    sleepHook = hook;
+}
+
+
+void hal_native_sei(void)
+{
+    SREG |= _BV(SREG_I);
+    dispatch();
+}
+
+
+void hal_native_cli(void)
+{
+    SREG &= ~_BV(SREG_I);
+}
+
+
+void hal_native_sreg_restore(const uint8_t *sreg)
+{
+    SREG = *sreg;
+    dispatch();
+}
+
+
+void hal_native_wdt_reset(void)
+{
+    wdt_update();
+    if (wdtAt != NEVER) wdtAt = now + wdt_period();
+}
+
+
+void hal_native_pin(char port, uint8_t mask, uint8_t level)
+{
+    uint8_t p = (uint8_t)(port - 'B');
+    if (p > 2) return;
+
+    extMask[p] |= mask;
+    if (level) extLevel[p] |= mask;
+    else extLevel[p] &= ~mask;
+    io_sync();
+    dispatch();
+}
+
+
+void hal_native_pin_release(char port, uint8_t mask)
+{
+    uint8_t p = (uint8_t)(port - 'B');
+    if (p > 2) return;
+
+    extMask[p] &= ~mask;
+    io_sync();
+    dispatch();
+}
+
+
+volatile uint8_t *hal_native_pinx(uint8_t addr)
+{
+    pins_update();
+    return &hal_io[addr];
+}
+
+
+/*
+ * EEPROM: a write keeps it busy for 3.4 ms, an access waits for that as
+ * the avr-libc functions do.
+ */
+uint8_t hal_native_ee_read(uint16_t addr)
+{
+    if (eeReadyAt > now) run_to(eeReadyAt);
+    return eeprom[addr & E2END];
+}
+
+
+void hal_native_ee_write(uint16_t addr, uint8_t value)
+{
+    if (eeReadyAt > now) run_to(eeReadyAt);
+    eeprom[addr & E2END] = value;
+    eeReadyAt = now + EE_WRITE_CYCLES;
+}
+
+
+uint8_t hal_native_ee_ready(void)
+{
+    if (eeReadyAt > now) hal_native_spin();
+    return eeReadyAt <= now;
+}
+
+
+/*
+ * TWI: the master waits for each byte (9 SCL periods at the TWBR rate),
+ * interrupts run meanwhile as they would on the AVR.
+ */
+static uint64_t twi_scl(void)
+{
+    return 16 + 2UL * TWBR * (1UL << (2 * (TWSR & 0x03)));
+}
+
+
+uint8_t hal_native_twi_attach(const hal_native_twi_device_t *dev)
+{
+    if (twiCount == HAL_NATIVE_TWI_DEVICES) return 1;
+    twiDevices[twiCount++] = dev;
+    return 0;
+}
+
+
+void hal_native_twi_start(void)
+{
+    if (twiSlave && twiSlave->stop) twiSlave->stop(twiSlave->ctx);
+    twiSlave = NULL;
+    twiAddressing = 1;
+    run_to(now + twi_scl());
+}
+
+
+uint8_t hal_native_twi_write(uint8_t data)
+{
+    run_to(now + 9 * twi_scl());
+
+    if (twiAddressing) {
+        twiAddressing = 0;
+        for (uint8_t i = 0; i < twiCount; i++) {
+            if (twiDevices[i]->addr == data >> 1) {
+                twiSlave = twiDevices[i];
+                twiRead = data & 0x01;
+                if (twiSlave->start) twiSlave->start(twiSlave->ctx, twiRead);
+                return 0;
+            }
+        }
+        return 1;
+    }
+    if (!twiSlave || twiRead || !twiSlave->write) return 1;
+    return twiSlave->write(twiSlave->ctx, data);
+}
+
+
+uint8_t hal_native_twi_read(uint8_t ack)
+{
+    run_to(now + 9 * twi_scl());
+
+    if (!twiSlave || !twiRead || !twiSlave->read) return 0xff;
+    return twiSlave->read(twiSlave->ctx, ack);
+}
+
+
+void hal_native_twi_stop(void)
+{
+    if (twiSlave && twiSlave->stop) twiSlave->stop(twiSlave->ctx);
+    twiSlave = NULL;
+    twiAddressing = 0;
+    run_to(now + twi_scl());
+}
+
+
+/*
+ * avr-libc extensions of stdlib.h
+ */
+char *ultoa(unsigned long value, char *s, int radix)
+{
+    char tmp[8 * sizeof(long) + 1];
+    uint8_t n = 0;
+
+    do {
+        uint8_t digit = value % radix;
+        tmp[n++] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        value /= radix;
+    } while (value);
+
+    for (uint8_t i = 0; i < n; i++) s[i] = tmp[n - 1 - i];
+    s[n] = '\0';
+    return s;
+}
+
+
+char *ltoa(long value, char *s, int radix)
+{
+    if (value < 0 && radix == 10) {
+        s[0] = '-';
+        ultoa(-(unsigned long)value, s + 1, radix);
+        return s;
+    }
+    return ultoa((unsigned long)value, s, radix);
+}
+
+
+char *utoa(unsigned int value, char *s, int radix)
+{
+    return ultoa(value, s, radix);
+}
+
+
+char *itoa(int value, char *s, int radix)
+{
+    if (radix != 10) return ultoa((unsigned int)value, s, radix);
+    return ltoa(value, s, radix);
+}
+
+
+/*
+ * Process setup: reset values of the registers that are not zero, the
+ * environment, and the EEPROM file.
+ */
+static void on_signal(int sig)
+{
+    (void)sig;
+    stopRequested = 1;      // exits at the next step, so atexit() runs
+}
+
+
+static void on_exit_save(void)
+{
+    fflush(stdout);
+    if (!eepromFile) return;
+
+    FILE *f = fopen(eepromFile, "wb");
+    if (!f || fwrite(eeprom, 1, sizeof(eeprom), f) != sizeof(eeprom))
+        fprintf(stderr, "hal: cannot write %s\n", eepromFile);
+    if (f) fclose(f);
+}
+
+
+__attribute__((constructor))
+static void hal_native_init(void)
+{
+    const char *env;
+
+    memset(eeprom, 0xff, sizeof(eeprom));
+    eepromFile = getenv("HAL_EEPROM");
+    if (eepromFile) {
+        FILE *f = fopen(eepromFile, "rb");
+        if (f) {
+            if (fread(eeprom, 1, sizeof(eeprom), f) != sizeof(eeprom))
+                fprintf(stderr, "hal: %s is short, rest erased\n", eepromFile);
+            fclose(f);
+        }
+    }
+    if ((env = getenv("HAL_RUN_MS")) != NULL)
+        runUntil = strtoull(env, NULL, 10) * (F_CPU / 1000);
+    if ((env = getenv("HAL_REALTIME")) != NULL)
+        realtime = atoi(env) != 0;
+    if ((env = getenv("HAL_WAKE")) != NULL) {
+        // port letter, pin number, ':', ms, e.g. B0:2000
+        if (env[0] >= 'B' && env[0] <= 'D' && env[1] >= '0' && env[1] <= '7' && env[2] == ':') {
+            wakePort = (uint8_t)(env[0] - 'B');
+            wakeMask = (uint8_t)(1 << (env[1] - '0'));
+            wakeAfter = strtoull(env + 3, NULL, 10) * (F_CPU / 1000);
+        }
+        else {
+            fprintf(stderr, "hal: HAL_WAKE is <port><pin>:<ms>, e.g. B0:2000\n");
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &wallStart);
+    atexit(on_exit_save);
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    UCSR0A = _BV(UDRE0);
+    UCSR0C = _BV(UCSZ01) | _BV(UCSZ00);
+    TWBR = 0;
+    TWSR = 0xf8;
+    pins_update();
+}
+
+#endif
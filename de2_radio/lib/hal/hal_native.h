@@ -0,0 +1,195 @@
+#ifndef HAL_NATIVE_H
+# define HAL_NATIVE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @defgroup hal_native Host build of the HAL <hal_native.h>
+ * @code #include <hal_native.h> @endcode
+ *
+ * @brief Virtual ATmega328P peripherals for running the firmware as a
+ *        Linux process (pio run -e native).
+ *
+ * Time is counted in CPU cycles of 16 MHz and only moves on when the
+ * firmware sleeps, delays, spins in hal_spin() or uses the TWI bus. Each
+ * step goes to the next event (Timer2 compare, Timer1 overflow, watchdog,
+ * USART byte, EEPROM write done), sets the interrupt flag and, with
+ * interrupts enabled, calls the vectors in AVR priority order.
+ *
+ *   - Timer1 (normal mode) and Timer2 (normal or CTC) count with their
+ *     prescalers; TCNTx and the flags in TIFRx are kept up to date. Both
+ *     stop in power-down. Timer0 and SPI are not modelled.
+ *   - USART0: bytes written by the UDRE interrupt go to stdout at the
+ *     programmed baud rate, stdin bytes arrive as receive interrupts.
+ *   - EEPROM: 1 KiB, a write takes 3.4 ms, EE_READY fires when done.
+ *   - Watchdog: interrupt and reset modes with the WDP periods.
+ *   - GPIO: PINx follows the outputs and pull-ups, a test drives inputs
+ *     with hal_native_pin(); changes raise the PCINT flags.
+ *   - TWI: devices attached with hal_native_twi_attach(), 9 SCL periods
+ *     per byte; an address nobody answers reads as NACK and 0xff. The
+ *     Si4703 model of si4703_sim.h attaches itself.
+ *
+ * Environment variables of the process:
+ *   - HAL_RUN_MS: exit after this much virtual time
+ *   - HAL_REALTIME: non-zero to let virtual time not run ahead of the
+ *     wall clock while sleeping (interactive use)
+ *   - HAL_EEPROM: file with the EEPROM content, loaded at start and
+ *     saved at exit
+ *   - HAL_WAKE: <port><pin>:<ms>, e.g. B0:2000: every power-down ends
+ *     after ms with that pin held low for 100 ms, as a button pressed
+ *     to wake the MCU
+ *
+ * Power-down ends the process unless HAL_WAKE is set or a sleep hook is
+ * installed to drive the wakeup pins, since nothing else could ever wake
+ * the MCU.
+ * @{
+ */
+
+// -- Includes -------------------------------------------------------
+#include <stdint.h>
+
+
+// -- Defines --------------------------------------------------------
+#define HAL_NATIVE_TWI_DEVICES  4   /**< @brief Devices on the bus */
+
+
+// -- Types ----------------------------------------------------------
+/** @brief A TWI slave on the simulated bus */
+typedef struct {
+    uint8_t addr;                                   /**< @brief 7-bit address */
+    void (*start)(void *ctx, uint8_t read);         /**< @brief Addressed after (repeated) START */
+    uint8_t (*write)(void *ctx, uint8_t data);      /**< @brief Byte from the master, returns 0 for ACK */
+    uint8_t (*read)(void *ctx, uint8_t ack);        /**< @brief Byte to the master, ack from it */
+    void (*stop)(void *ctx);                        /**< @brief STOP, or START to another slave */
+    void *ctx;                                      /**< @brief Handed to the callbacks */
+} hal_native_twi_device_t;
+
+
+// -- Global variables -----------------------------------------------
+/** @brief I/O space at the ATmega328P data addresses 0x00..0xff */
+extern volatile uint8_t hal_io[0x100];
+
+
+// -- Function prototypes --------------------------------------------
+/**
+ * @brief  CPU cycles since the start of the process.
+ * @return Virtual time in cycles of F_CPU
+ */
+uint64_t hal_native_cycles(void);
+
+
+/**
+ * @brief  Let time pass as in a busy loop, interrupts run if enabled.
+ * @param  cycles CPU cycles
+ * @return none
+ */
+void hal_native_advance(uint64_t cycles);
+
+
+/**
+ * @brief  Move to the next event, see hal_spin(). Exits the process if
+ *         there is none, since the loop would never end.
+ * @return none
+ */
+void hal_native_spin(void);
+
+
+/**
+ * @brief  sleep_cpu(): sleep in the SMCR mode until an interrupt.
+ * @return none
+ */
+void hal_native_sleep(void);
+
+
+/**
+ * @brief  Called on every sleep with the SMCR sleep mode, before time
+ *         moves on. It may drive pins or attach devices.
+ * @param  hook Function, NULL for none
+ * @return none
+ */
+void hal_native_set_sleep_hook(void (*hook)(uint8_t mode));
+
+
+/** @brief sei(): enable interrupts and run the pending ones */
+void hal_native_sei(void);
+
+/** @brief cli(): disable interrupts */
+void hal_native_cli(void);
+
+/** @brief SREG write of ATOMIC_BLOCK, runs pending interrupts if I is set */
+void hal_native_sreg_restore(const uint8_t *sreg);
+
+/** @brief wdt_reset(): restart the watchdog period */
+void hal_native_wdt_reset(void);
+
+
+/**
+ * @brief  Drive input pins from outside, as a button or an encoder.
+ * @param  port 'B', 'C' or 'D'
+ * @param  mask Pins
+ * @param  level 0 low, otherwise high
+ * @return none
+ */
+void hal_native_pin(char port, uint8_t mask, uint8_t level);
+
+
+/**
+ * @brief  Stop driving pins; they follow their pull-ups again.
+ * @param  port 'B', 'C' or 'D'
+ * @param  mask Pins
+ * @return none
+ */
+void hal_native_pin_release(char port, uint8_t mask);
+
+
+/**
+ * @brief  PINB, PINC or PIND as read by the firmware: the pins are
+ *         brought up to date first, so a read right after a PORTx or
+ *         DDRx write sees the new level, as on the AVR one synchronizer
+ *         cycle later.
+ * @param  addr Data space address of the PINx register
+ * @return The register cell
+ */
+volatile uint8_t *hal_native_pinx(uint8_t addr);
+
+
+/** @brief hal_ee_read(), waits for a running write */
+uint8_t hal_native_ee_read(uint16_t addr);
+
+/** @brief hal_ee_write(), waits for a running write */
+void hal_native_ee_write(uint16_t addr, uint8_t value);
+
+/** @brief eeprom_is_ready(); lets time pass while a write runs */
+uint8_t hal_native_ee_ready(void);
+
+
+/**
+ * @brief  Put a slave on the simulated TWI bus.
+ * @param  dev Device, must stay valid
+ * @return 0 if attached, 1 if the bus is full
+ */
+uint8_t hal_native_twi_attach(const hal_native_twi_device_t *dev);
+
+
+/** @brief START condition, see twi_start() */
+void hal_native_twi_start(void);
+
+/** @brief Address or data byte, see twi_write(); returns 0 for ACK */
+uint8_t hal_native_twi_write(uint8_t data);
+
+/** @brief Data byte from the slave, see twi_read() */
+uint8_t hal_native_twi_read(uint8_t ack);
+
+/** @brief STOP condition, see twi_stop() */
+void hal_native_twi_stop(void);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
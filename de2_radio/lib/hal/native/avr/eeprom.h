@@ -0,0 +1,56 @@
+#ifndef HAL_NATIVE_AVR_EEPROM_H
+# define HAL_NATIVE_AVR_EEPROM_H
+
+/*
+ * Host build: the avr-libc EEPROM calls on the EEPROM of hal_native.c,
+ * including its write time. Addresses are EEPROM offsets cast to pointers.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <avr/io.h>
+
+#define EEMEM
+
+#define eeprom_is_ready()   hal_native_ee_ready()
+#define eeprom_busy_wait()  do {} while (!eeprom_is_ready())
+
+static inline uint16_t hal_native_ee_addr_(const void *p)
+{
+    return (uint16_t)((uintptr_t)p & E2END);
+}
+
+static inline uint8_t eeprom_read_byte(const uint8_t *p)
+{
+    return hal_native_ee_read(hal_native_ee_addr_(p));
+}
+
+static inline void eeprom_write_byte(uint8_t *p, uint8_t value)
+{
+    hal_native_ee_write(hal_native_ee_addr_(p), value);
+}
+
+static inline void eeprom_update_byte(uint8_t *p, uint8_t value)
+{
+    if (eeprom_read_byte(p) != value) eeprom_write_byte(p, value);
+}
+
+static inline void eeprom_read_block(void *dst, const void *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        ((uint8_t *)dst)[i] = eeprom_read_byte((const uint8_t *)src + i);
+}
+
+static inline void eeprom_write_block(const void *src, void *dst, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        eeprom_write_byte((uint8_t *)dst + i, ((const uint8_t *)src)[i]);
+}
+
+static inline void eeprom_update_block(const void *src, void *dst, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        eeprom_update_byte((uint8_t *)dst + i, ((const uint8_t *)src)[i]);
+}
+
+#endif
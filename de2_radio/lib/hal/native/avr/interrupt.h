@@ -0,0 +1,26 @@
+#ifndef HAL_NATIVE_AVR_INTERRUPT_H
+# define HAL_NATIVE_AVR_INTERRUPT_H
+
+/*
+ * Host build: an ISR is a plain function named after its vector number,
+ * hal_native.c calls it while interrupts are enabled and its flag is set.
+ */
+
+#include <avr/io.h>
+
+#ifdef __cplusplus
+# define ISR(vector, ...)   extern "C" void vector(void); extern "C" void vector(void)
+#else
+# define ISR(vector, ...)   void vector(void); void vector(void)
+#endif
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+#define ISR_NAKED
+#define ISR_ALIASOF(vector)
+#define EMPTY_INTERRUPT(vector) ISR(vector) {}
+
+#define sei()   hal_native_sei()
+#define cli()   hal_native_cli()
+#define reti()  return
+
+#endif
@@ -0,0 +1,298 @@
+#ifndef HAL_NATIVE_AVR_IO_H
+# define HAL_NATIVE_AVR_IO_H
+
+/*
+ * Host build: ATmega328P I/O registers as cells of hal_io[] at their data
+ * space addresses, so that DDR(PORTC) style arithmetic and the fixed
+ * addresses in pin.h keep working. Bit names are macros as in avr-libc,
+ * code tests them with #if defined(). hal_native.c gives the cells their
+ * behaviour.
+ */
+
+#include <stdint.h>
+#include <hal_native.h>
+
+#define __AVR_ATmega328P__  1
+
+#define _SFR_MEM8(addr)     (hal_io[addr])
+#define _SFR_MEM16(addr)    (*(volatile uint16_t *)&hal_io[addr])
+#define _BV(bit)            (1 << (bit))
+
+#define RAMEND      0x08FF
+#define E2END       0x03FF
+#define E2SIZE      (E2END + 1)
+
+// -- Ports
+#define PINB        (*hal_native_pinx(0x23))
+#define DDRB        _SFR_MEM8(0x24)
+#define PORTB       _SFR_MEM8(0x25)
+#define PINC        (*hal_native_pinx(0x26))
+#define DDRC        _SFR_MEM8(0x27)
+#define PORTC       _SFR_MEM8(0x28)
+#define PIND        (*hal_native_pinx(0x29))
+#define DDRD        _SFR_MEM8(0x2A)
+#define PORTD       _SFR_MEM8(0x2B)
+
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PB6 6
+#define PB7 7
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+#define PC4 4
+#define PC5 5
+#define PC6 6
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+
+// -- Interrupt flags and masks
+#define TIFR0       _SFR_MEM8(0x35)
+#define TIFR1       _SFR_MEM8(0x36)
+#define TIFR2       _SFR_MEM8(0x37)
+#define PCIFR       _SFR_MEM8(0x3B)
+#define EIFR        _SFR_MEM8(0x3C)
+#define EIMSK       _SFR_MEM8(0x3D)
+#define PCICR       _SFR_MEM8(0x68)
+#define EICRA       _SFR_MEM8(0x69)
+#define PCMSK0      _SFR_MEM8(0x6B)
+#define PCMSK1      _SFR_MEM8(0x6C)
+#define PCMSK2      _SFR_MEM8(0x6D)
+#define TIMSK0      _SFR_MEM8(0x6E)
+#define TIMSK1      _SFR_MEM8(0x6F)
+#define TIMSK2      _SFR_MEM8(0x70)
+
+#define TOV0    0
+#define OCF0A   1
+#define OCF0B   2
+#define TOV1    0
+#define OCF1A   1
+#define OCF1B   2
+#define ICF1    5
+#define TOV2    0
+#define OCF2A   1
+#define OCF2B   2
+#define PCIF0   0
+#define PCIF1   1
+#define PCIF2   2
+#define INT0    0
+#define INT1    1
+#define PCIE0   0
+#define PCIE1   1
+#define PCIE2   2
+#define ISC00   0
+#define ISC01   1
+#define ISC10   2
+#define ISC11   3
+#define TOIE0   0
+#define OCIE0A  1
+#define OCIE0B  2
+#define TOIE1   0
+#define OCIE1A  1
+#define OCIE1B  2
+#define ICIE1   5
+#define TOIE2   0
+#define OCIE2A  1
+#define OCIE2B  2
+
+// -- General purpose, EEPROM
+#define GPIOR0      _SFR_MEM8(0x3E)
+#define EECR        _SFR_MEM8(0x3F)
+#define EEDR        _SFR_MEM8(0x40)
+#define EEAR        _SFR_MEM16(0x41)
+#define GPIOR1      _SFR_MEM8(0x4A)
+#define GPIOR2      _SFR_MEM8(0x4B)
+
+#define EERE    0
+#define EEPE    1
+#define EEMPE   2
+#define EERIE   3
+
+// -- Timer0
+#define GTCCR       _SFR_MEM8(0x43)
+#define TCCR0A      _SFR_MEM8(0x44)
+#define TCCR0B      _SFR_MEM8(0x45)
+#define TCNT0       _SFR_MEM8(0x46)
+#define OCR0A       _SFR_MEM8(0x47)
+#define OCR0B       _SFR_MEM8(0x48)
+
+#define WGM00   0
+#define WGM01   1
+#define CS00    0
+#define CS01    1
+#define CS02    2
+#define WGM02   3
+
+// -- SPI (registers only, not modelled)
+#define SPCR        _SFR_MEM8(0x4C)
+#define SPSR        _SFR_MEM8(0x4D)
+#define SPDR        _SFR_MEM8(0x4E)
+
+#define SPR0    0
+#define SPR1    1
+#define CPHA    2
+#define CPOL    3
+#define MSTR    4
+#define DORD    5
+#define SPE     6
+#define SPIE    7
+#define SPI2X   0
+#define WCOL    6
+#define SPIF    7
+
+// -- Core
+#define SMCR        _SFR_MEM8(0x53)
+#define MCUSR       _SFR_MEM8(0x54)
+#define MCUCR       _SFR_MEM8(0x55)
+#define SREG        _SFR_MEM8(0x5F)
+#define WDTCSR      _SFR_MEM8(0x60)
+#define CLKPR       _SFR_MEM8(0x61)
+#define PRR         _SFR_MEM8(0x64)
+
+#define SE      0
+#define SM0     1
+#define SM1     2
+#define SM2     3
+#define PORF    0
+#define EXTRF   1
+#define BORF    2
+#define WDRF    3
+#define WDP0    0
+#define WDP1    1
+#define WDP2    2
+#define WDE     3
+#define WDCE    4
+#define WDP3    5
+#define WDIE    6
+#define WDIF    7
+#define SREG_I  7
+
+// -- Timer1
+#define TCCR1A      _SFR_MEM8(0x80)
+#define TCCR1B      _SFR_MEM8(0x81)
+#define TCCR1C      _SFR_MEM8(0x82)
+#define TCNT1       _SFR_MEM16(0x84)
+#define ICR1        _SFR_MEM16(0x86)
+#define OCR1A       _SFR_MEM16(0x88)
+#define OCR1B       _SFR_MEM16(0x8A)
+
+#define WGM10   0
+#define WGM11   1
+#define CS10    0
+#define CS11    1
+#define CS12    2
+#define WGM12   3
+#define WGM13   4
+
+// -- Timer2
+#define TCCR2A      _SFR_MEM8(0xB0)
+#define TCCR2B      _SFR_MEM8(0xB1)
+#define TCNT2       _SFR_MEM8(0xB2)
+#define OCR2A       _SFR_MEM8(0xB3)
+#define OCR2B       _SFR_MEM8(0xB4)
+#define ASSR        _SFR_MEM8(0xB6)
+
+#define WGM20   0
+#define WGM21   1
+#define CS20    0
+#define CS21    1
+#define CS22    2
+#define WGM22   3
+
+// -- TWI (registers only, twi.c talks to the simulated bus)
+#define TWBR        _SFR_MEM8(0xB8)
+#define TWSR        _SFR_MEM8(0xB9)
+#define TWAR        _SFR_MEM8(0xBA)
+#define TWDR        _SFR_MEM8(0xBB)
+#define TWCR        _SFR_MEM8(0xBC)
+
+#define TWPS0   0
+#define TWPS1   1
+#define TWIE    0
+#define TWEN    2
+#define TWWC    3
+#define TWSTO   4
+#define TWSTA   5
+#define TWEA    6
+#define TWINT   7
+
+// -- USART0
+#define UCSR0A      _SFR_MEM8(0xC0)
+#define UCSR0B      _SFR_MEM8(0xC1)
+#define UCSR0C      _SFR_MEM8(0xC2)
+#define UBRR0       _SFR_MEM16(0xC4)
+#define UBRR0L      _SFR_MEM8(0xC4)
+#define UBRR0H      _SFR_MEM8(0xC5)
+#define UDR0        _SFR_MEM8(0xC6)
+
+#define MPCM0   0
+#define U2X0    1
+#define UPE0    2
+#define DOR0    3
+#define FE0     4
+#define UDRE0   5
+#define TXC0    6
+#define RXC0    7
+#define TXB80   0
+#define RXB80   1
+#define UCSZ02  2
+#define TXEN0   3
+#define RXEN0   4
+#define UDRIE0  5
+#define TXCIE0  6
+#define RXCIE0  7
+#define UCPOL0  0
+#define UCSZ00  1
+#define UCSZ01  2
+
+// -- Vectors, called by hal_native.c in this (priority) order
+#define INT0_vect           hal_vector_1
+#define INT1_vect           hal_vector_2
+#define PCINT0_vect         hal_vector_3
+#define PCINT1_vect         hal_vector_4
+#define PCINT2_vect         hal_vector_5
+#define WDT_vect            hal_vector_6
+#define TIMER2_COMPA_vect   hal_vector_7
+#define TIMER2_COMPB_vect   hal_vector_8
+#define TIMER2_OVF_vect     hal_vector_9
+#define TIMER1_CAPT_vect    hal_vector_10
+#define TIMER1_COMPA_vect   hal_vector_11
+#define TIMER1_COMPB_vect   hal_vector_12
+#define TIMER1_OVF_vect     hal_vector_13
+#define TIMER0_COMPA_vect   hal_vector_14
+#define TIMER0_COMPB_vect   hal_vector_15
+#define TIMER0_OVF_vect     hal_vector_16
+#define SPI_STC_vect        hal_vector_17
+#define USART_RX_vect       hal_vector_18
+#define USART_UDRE_vect     hal_vector_19
+#define USART_TX_vect       hal_vector_20
+#define ADC_vect            hal_vector_21
+#define EE_READY_vect       hal_vector_22
+#define ANALOG_COMP_vect    hal_vector_23
+#define TWI_vect            hal_vector_24
+#define SPM_READY_vect      hal_vector_25
+
+// -- avr-libc extensions of stdlib.h
+#ifdef __cplusplus
+extern "C" {
+#endif
+char *itoa(int value, char *s, int radix);
+char *utoa(unsigned int value, char *s, int radix);
+char *ltoa(long value, char *s, int radix);
+char *ultoa(unsigned long value, char *s, int radix);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
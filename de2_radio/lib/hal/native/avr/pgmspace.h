@@ -0,0 +1,34 @@
+#ifndef HAL_NATIVE_AVR_PGMSPACE_H
+# define HAL_NATIVE_AVR_PGMSPACE_H
+
+/*
+ * Host build: one address space, program memory is ordinary const data.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P               const char *
+#define PGM_VOID_P          const void *
+#define PSTR(s)             (s)
+
+#define pgm_read_byte(addr)     (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)     (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr)    (*(const uint32_t *)(addr))
+#define pgm_read_ptr(addr)      (*(const void * const *)(addr))
+
+#define memcmp_P        memcmp
+#define memcpy_P        memcpy
+#define strcmp_P        strcmp
+#define strncmp_P       strncmp
+#define strcpy_P        strcpy
+#define strncpy_P       strncpy
+#define strlen_P        strlen
+#define printf_P        printf
+#define sprintf_P       sprintf
+#define snprintf_P      snprintf
+#define vsnprintf_P     vsnprintf
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef HAL_NATIVE_AVR_SLEEP_H
+# define HAL_NATIVE_AVR_SLEEP_H
+
+/*
+ * Host build: sleep_cpu() lets virtual time run to the next interrupt
+ * that can wake the CPU in the SMCR mode.
+ */
+
+#include <avr/io.h>
+
+#define SLEEP_MODE_IDLE         (0x00 << 1)
+#define SLEEP_MODE_ADC          (0x01 << 1)
+#define SLEEP_MODE_PWR_DOWN     (0x02 << 1)
+#define SLEEP_MODE_PWR_SAVE     (0x03 << 1)
+#define SLEEP_MODE_STANDBY      (0x06 << 1)
+#define SLEEP_MODE_EXT_STANDBY  (0x07 << 1)
+
+#define set_sleep_mode(mode) \
+    (SMCR = (SMCR & ~(_BV(SM0) | _BV(SM1) | _BV(SM2))) | (mode))
+#define sleep_enable()      (SMCR |= _BV(SE))
+#define sleep_disable()     (SMCR &= ~_BV(SE))
+#define sleep_cpu()         do { if (SMCR & _BV(SE)) hal_native_sleep(); } while (0)
+#define sleep_mode()        do { sleep_enable(); sleep_cpu(); sleep_disable(); } while (0)
+#define sleep_bod_disable() do {} while (0)
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef HAL_NATIVE_AVR_WDT_H
+# define HAL_NATIVE_AVR_WDT_H
+
+/*
+ * Host build: the watchdog of hal_native.c, WDTCSR as on the AVR.
+ */
+
+#include <avr/io.h>
+
+#define WDTO_15MS   0
+#define WDTO_30MS   1
+#define WDTO_60MS   2
+#define WDTO_120MS  3
+#define WDTO_250MS  4
+#define WDTO_500MS  5
+#define WDTO_1S     6
+#define WDTO_2S     7
+#define WDTO_4S     8
+#define WDTO_8S     9
+
+#define wdt_reset() hal_native_wdt_reset()
+#define wdt_enable(value) \
+    do { \
+        wdt_reset(); \
+        WDTCSR = _BV(WDCE) | _BV(WDE); \
+        WDTCSR = _BV(WDE) | ((value) & 0x07) | (((value) & 0x08) ? _BV(WDP3) : 0); \
+    } while (0)
+#define wdt_disable() \
+    do { \
+        WDTCSR = _BV(WDCE) | _BV(WDE); \
+        WDTCSR = 0; \
+    } while (0)
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef HAL_NATIVE_UTIL_ATOMIC_H
+# define HAL_NATIVE_UTIL_ATOMIC_H
+
+/*
+ * Host build: ATOMIC_BLOCK as in avr-libc, on the SREG cell. Leaving the
+ * block with interrupts enabled runs the ones that became pending.
+ */
+
+#include <stdint.h>
+#include <avr/io.h>
+
+static inline uint8_t hal_native_atomic_enter_(void)
+{
+    uint8_t sreg = SREG;
+    hal_native_cli();
+    return sreg;
+}
+
+static inline void hal_native_force_on_(const uint8_t *sreg)
+{
+    (void)sreg;
+    hal_native_sei();
+}
+
+static inline void hal_native_force_off_(const uint8_t *sreg)
+{
+    (void)sreg;
+    hal_native_cli();
+}
+
+static inline uint8_t hal_native_nonatomic_enter_(void)
+{
+    uint8_t sreg = SREG;
+    hal_native_sei();
+    return sreg;
+}
+
+static inline uint8_t hal_native_atomic_once_(void) { return 1; }
+
+#define ATOMIC_BLOCK(type) \
+    for (type, hal_native_todo_ = hal_native_atomic_once_(); \
+         hal_native_todo_; hal_native_todo_ = 0)
+#define NONATOMIC_BLOCK(type) \
+    for (type, hal_native_todo_ = hal_native_atomic_once_(); \
+         hal_native_todo_; hal_native_todo_ = 0)
+
+#define ATOMIC_RESTORESTATE \
+    uint8_t hal_native_sreg_ __attribute__((__cleanup__(hal_native_sreg_restore))) = \
+        hal_native_atomic_enter_()
+#define ATOMIC_FORCEON \
+    uint8_t hal_native_sreg_ __attribute__((__cleanup__(hal_native_force_on_))) = \
+        (hal_native_cli(), 0)
+#define NONATOMIC_RESTORESTATE \
+    uint8_t hal_native_sreg_ __attribute__((__cleanup__(hal_native_sreg_restore))) = \
+        hal_native_nonatomic_enter_()
+#define NONATOMIC_FORCEOFF \
+    uint8_t hal_native_sreg_ __attribute__((__cleanup__(hal_native_force_off_))) = \
+        (hal_native_sei(), 0)
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef HAL_NATIVE_UTIL_DELAY_H
+# define HAL_NATIVE_UTIL_DELAY_H
+
+/*
+ * Host build: a delay is virtual time in which interrupts keep running.
+ */
+
+#include <avr/io.h>
+
+#ifndef F_CPU
+# define F_CPU 16000000UL
+#endif
+
+#define _delay_ms(ms)   hal_native_advance((uint64_t)((ms) * (F_CPU / 1000.0)))
+#define _delay_us(us)   hal_native_advance((uint64_t)((us) * (F_CPU / 1000000.0)))
+
+#endif
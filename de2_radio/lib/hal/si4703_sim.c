@@ -0,0 +1,507 @@
+/*
+ * Host build: Si4703 register model on the simulated TWI bus, see
+ * si4703_sim.h. Not part of the AVR build.
+ */
+
+#ifndef __AVR__
+
+// -- Includes -------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <hal_native.h>
+#include <presets.h>
+#include <si4703_sim.h>
+
+
+// -- Defines --------------------------------------------------------
+#ifndef F_CPU
+# define F_CPU 16000000UL
+#endif
+
+#define NEVER           UINT64_MAX
+#define MS_CYCLES       (F_CPU / 1000)
+#define GROUP_CYCLES    (F_CPU / 1000000 * SI4703_SIM_GROUP_US)
+
+#define LAND_START      8750        // frequency of landscape channel 0
+#define NOISE_RSSI      6           // floor, up to 6 dB more per channel
+#define RDS_MIN_RSSI    20          // weaker stations send no RDS
+#define STEREO_MIN_RSSI 20          // below this the pilot is lost
+
+// Register addresses
+#define DEVICEID        0x00
+#define CHIPID          0x01
+#define POWERCFG        0x02
+#define CHANNEL         0x03
+#define SYSCONFIG1      0x04
+#define SYSCONFIG2      0x05
+#define TEST1           0x07
+#define STATUSRSSI      0x0A
+#define READCHAN        0x0B
+#define RDSA            0x0C
+
+// Bits
+#define ENABLE          0x0001      // POWERCFG
+#define DISABLE         0x0040
+#define SEEK            0x0100
+#define SEEKUP          0x0200
+#define SKMODE          0x0400
+#define RDSM            0x0800
+#define MONO            0x2000
+#define TUNE            0x8000      // CHANNEL
+#define CHAN_MASK       0x03ff
+#define RDS             0x1000      // SYSCONFIG1
+#define XOSCEN          0x8000      // TEST1
+#define ST              0x0100      // STATUSRSSI
+#define RDSS            0x0800
+#define SFBL            0x2000
+#define STC             0x4000
+#define RDSR            0x8000
+#define BLERA_SHIFT     9
+#define BLERB_SHIFT     14          // READCHAN
+#define BLERC_SHIFT     12
+#define BLERD_SHIFT     10
+
+#define DEVICEID_RESET  0x1242      // Silicon Labs, Si4702/03
+#define CHIPID_OFF      0x1000      // rev C, device reads 0 until powered
+#define CHIPID_ON       0x1253      // rev C, Si4703, firmware 19
+#define TEST1_RESET     0x0100
+
+
+// -- Types ----------------------------------------------------------
+typedef enum { OP_IDLE, OP_TUNE, OP_SEEK, OP_DONE } op_t;
+
+
+// -- Local variables ------------------------------------------------
+static uint16_t reg[16];                // by register address
+static uint8_t powered;
+static op_t op;
+static uint64_t opAt = NEVER;           // tune done / next seek step
+static uint16_t chan;                   // channel the receiver is on
+static uint16_t seekFrom;
+
+static uint64_t groupAt = NEVER;        // next RDS group
+static uint64_t rdsrUntil;
+static uint16_t groupSeq;
+static uint8_t groupsHeard;             // on this channel, for RDSS
+
+static si4703_sim_channel_t land[SI4703_SIM_CHANNELS];
+static uint8_t blerPercent;
+static uint32_t rnd = 0x2545f491;       // fixed seed, runs repeat
+
+static si4703_sim_stats_t stats;
+static uint8_t rdPos, wrPos;            // byte in the transaction
+static uint8_t rdLow, wrHigh;
+
+
+// -- Local functions ------------------------------------------------
+static uint8_t random8(void)
+{
+    rnd ^= rnd << 13;                   // xorshift32
+    rnd ^= rnd >> 17;
+    rnd ^= rnd << 5;
+    return rnd >> 24;
+}
+
+
+/*
+ * Channel grid of BAND and SPACE, in 10 kHz as the driver counts.
+ */
+static int band_start(void)
+{
+    return ((reg[SYSCONFIG2] >> 6) & 0x03) == 0 ? 8750 : 7600;
+}
+
+
+static uint16_t band_top(void)
+{
+    static const uint8_t spacing[4] = { 20, 10, 5, 5 };
+    int end = ((reg[SYSCONFIG2] >> 6) & 0x03) == 2 ? 9000 : 10800;
+    return (end - band_start()) / spacing[(reg[SYSCONFIG2] >> 4) & 0x03];
+}
+
+
+static int chan_freq(uint16_t ch)
+{
+    static const uint8_t spacing[4] = { 20, 10, 5, 5 };
+    return band_start() + ch * spacing[(reg[SYSCONFIG2] >> 4) & 0x03];
+}
+
+
+static si4703_sim_channel_t noise(int freq)
+{
+    si4703_sim_channel_t c = { (uint8_t)(NOISE_RSSI + (uint16_t)freq / 5 * 13 % 7), 0, 0 };
+    return c;
+}
+
+
+/*
+ * Signal on the current channel into STATUSRSSI, with a little jitter
+ * per measurement as the real RSSI has.
+ */
+static void measure(void)
+{
+    si4703_sim_channel_t c = si4703_sim_get_channel(chan_freq(chan));
+    int rssi = c.rssi + random8() % 5 - 2;
+
+    if (rssi < 0) rssi = 0;
+    reg[STATUSRSSI] &= ~(0x00ff | ST);
+    reg[STATUSRSSI] |= rssi;
+    if (c.stereo && !(reg[POWERCFG] & MONO) && rssi >= STEREO_MIN_RSSI)
+        reg[STATUSRSSI] |= ST;
+    reg[READCHAN] = (reg[READCHAN] & ~CHAN_MASK) | chan;
+}
+
+
+static void rds_stop(void)
+{
+    groupAt = NEVER;
+    groupsHeard = 0;
+    reg[STATUSRSSI] &= ~(RDSR | RDSS | (0x03 << BLERA_SHIFT));
+    reg[READCHAN] &= CHAN_MASK;
+}
+
+
+static void op_done(uint8_t failed)
+{
+    op = OP_DONE;
+    measure();
+    reg[STATUSRSSI] |= STC | (failed ? SFBL : 0);
+    groupAt = opAt + GROUP_CYCLES;      // receiver locks, first group next
+    opAt = NEVER;
+}
+
+
+/*
+ * One seek step: next channel, stop on a signal at SEEKTH, at the band
+ * edge with SKMODE, or back where the seek began.
+ */
+static void seek_step(void)
+{
+    uint16_t top = band_top();
+
+    if (reg[POWERCFG] & SEEKUP) {
+        if (chan >= top) {
+            if (reg[POWERCFG] & SKMODE) { op_done(1); return; }
+            chan = 0;
+        } else {
+            chan++;
+        }
+    } else {
+        if (chan == 0 || chan > top) {
+            if (reg[POWERCFG] & SKMODE) { op_done(1); return; }
+            chan = top;
+        } else {
+            chan--;
+        }
+    }
+
+    measure();
+    if (chan == seekFrom) { op_done(1); return; }
+    if ((reg[STATUSRSSI] & 0x00ff) >= (reg[SYSCONFIG2] >> 8)) { op_done(0); return; }
+    opAt += SI4703_SIM_SEEK_MS * MS_CYCLES;
+}
+
+
+/*
+ * Next RDS group of the station: 0A with two PS characters and 2A with
+ * four radiotext characters, alternating.
+ */
+static void rds_group(uint64_t at)
+{
+    int freq = chan_freq(chan);
+    si4703_sim_channel_t c = si4703_sim_get_channel(freq);
+    char ps[9], rt[65];
+    uint16_t block[4];
+    uint8_t level[4], rate, lost = 0;
+
+    if (!c.pi || c.rssi < RDS_MIN_RSSI || !(reg[SYSCONFIG1] & RDS)) return;
+
+    unsigned mhz = (unsigned)freq / 100 % 1000, khz = (unsigned)freq / 10 % 10;
+    snprintf(ps, sizeof(ps), "FM%3u.%u ", mhz, khz);
+    memset(rt, ' ', sizeof(rt) - 1);
+    rt[snprintf(rt, sizeof(rt), "Simulated station %u.%u MHz, PI %04X", mhz, khz, c.pi)] = '\r';
+
+    block[0] = c.pi;
+    if (!(groupSeq & 1)) {
+        uint8_t seg = (groupSeq >> 1) & 0x03;
+        block[1] = 0x0008 | seg;                    // 0A, music, segment
+        block[2] = 0xe0cd;                          // no AF list
+        block[3] = (uint8_t)ps[2 * seg] << 8 | (uint8_t)ps[2 * seg + 1];
+    } else {
+        uint8_t seg = (groupSeq >> 1) & 0x0f;
+        block[1] = 0x2000 | seg;                    // 2A, text A, segment
+        block[2] = (uint8_t)rt[4 * seg] << 8 | (uint8_t)rt[4 * seg + 1];
+        block[3] = (uint8_t)rt[4 * seg + 2] << 8 | (uint8_t)rt[4 * seg + 3];
+    }
+    groupSeq++;
+    stats.groups++;
+
+    // weak stations lose more blocks
+    rate = blerPercent;
+    if (c.rssi < 30) rate += 3 * (30 - c.rssi);
+    for (uint8_t i = 0; i < 4; i++) {
+        level[i] = 0;
+        if (random8() % 100 < rate) {
+            level[i] = 1 + random8() % 3;
+            if (level[i] == 3) {
+                block[i] ^= 1 << (random8() & 0x0f);
+                lost = 1;
+            }
+        }
+    }
+    if (lost && !(reg[POWERCFG] & RDSM)) return;   // standard mode drops it
+
+    memcpy(&reg[RDSA], block, sizeof(block));
+    reg[STATUSRSSI] = (reg[STATUSRSSI] & ~(0x03 << BLERA_SHIFT)) | RDSR
+                    | level[0] << BLERA_SHIFT;
+    reg[READCHAN] = (reg[READCHAN] & CHAN_MASK) | level[1] << BLERB_SHIFT
+                  | level[2] << BLERC_SHIFT | level[3] << BLERD_SHIFT;
+    if (++groupsHeard >= 2) {
+        groupsHeard = 2;
+        reg[STATUSRSSI] |= RDSS;
+    }
+    rdsrUntil = at + SI4703_SIM_RDSR_MS * MS_CYCLES;
+}
+
+
+/*
+ * Bring the chip up to the current virtual time.
+ */
+static void update(void)
+{
+    uint64_t now = hal_native_cycles();
+
+    while (opAt <= now) {
+        if (op == OP_TUNE) {
+            chan = reg[CHANNEL] & CHAN_MASK;
+            op_done(0);
+        } else {
+            seek_step();
+        }
+    }
+
+    if (groupAt <= now) {
+        // a long sleep skips groups; only the last one can be seen
+        uint64_t missed = (now - groupAt) / GROUP_CYCLES;
+        groupSeq += missed;
+        stats.groups += missed;
+        groupAt += missed * GROUP_CYCLES;
+        rds_group(groupAt);
+        groupAt += GROUP_CYCLES;
+    }
+    if (rdsrUntil <= now) reg[STATUSRSSI] &= ~RDSR;
+}
+
+
+/*
+ * A written register takes effect: power, tune and seek start on the
+ * rising control bit, clearing TUNE and SEEK ends the operation.
+ */
+static void write_reg(uint8_t addr, uint16_t value)
+{
+    uint16_t old = reg[addr];
+
+    if (addr < POWERCFG || addr >= STATUSRSSI) return;     // read only
+    reg[addr] = value;
+
+    if (addr == POWERCFG) {
+        if ((value & ENABLE) && (value & DISABLE)) {
+            powered = 0;
+            op = OP_IDLE;
+            opAt = NEVER;
+            rds_stop();
+            reg[POWERCFG] &= ~(ENABLE | DISABLE);
+            reg[CHIPID] = CHIPID_OFF;
+            reg[STATUSRSSI] &= ~(0x00ff | ST | STC | SFBL);
+            return;
+        }
+        if ((value & ENABLE) && !powered && (reg[TEST1] & XOSCEN)) {
+            powered = 1;
+            reg[CHIPID] = CHIPID_ON;
+        }
+    }
+    if (!powered || (addr != POWERCFG && addr != CHANNEL)) return;
+
+    uint16_t ctl = (reg[POWERCFG] & SEEK) | (reg[CHANNEL] & TUNE);
+    uint16_t was = addr == POWERCFG ? (old & SEEK) | (reg[CHANNEL] & TUNE)
+                                    : (reg[POWERCFG] & SEEK) | (old & TUNE);
+
+    if (op == OP_IDLE && (ctl & ~was)) {
+        rds_stop();
+        reg[STATUSRSSI] &= ~(STC | SFBL);
+        if (ctl & TUNE) {
+            op = OP_TUNE;
+            opAt = hal_native_cycles() + SI4703_SIM_TUNE_MS * MS_CYCLES;
+            stats.tunes++;
+        } else {
+            op = OP_SEEK;
+            seekFrom = chan;
+            opAt = hal_native_cycles() + SI4703_SIM_SEEK_MS * MS_CYCLES;
+            stats.seeks++;
+        }
+    } else if (op != OP_IDLE && !ctl) {
+        if (op == OP_TUNE) chan = reg[CHANNEL] & CHAN_MASK;
+        if (op != OP_DONE) {                        // cut short, no STC
+            measure();
+            groupAt = hal_native_cycles() + GROUP_CYCLES;
+        }
+        op = OP_IDLE;
+        opAt = NEVER;
+        reg[STATUSRSSI] &= ~(STC | SFBL);
+    }
+}
+
+
+/*
+ * Bus callbacks. Reads run from 0x0A and wrap after 0x0F, writes run
+ * from 0x02; every transaction begins anew.
+ */
+static void bus_start(void *ctx, uint8_t read)
+{
+    (void)ctx;
+    (void)read;
+    stats.transactions++;
+    rdPos = wrPos = 0;
+    update();
+}
+
+
+static uint8_t bus_write(void *ctx, uint8_t data)
+{
+    (void)ctx;
+    stats.writeBytes++;
+    if (!(wrPos & 1)) {
+        wrHigh = data;
+    } else {
+        uint8_t addr = (POWERCFG + (wrPos >> 1)) & 0x0f;
+        update();
+        write_reg(addr, wrHigh << 8 | data);
+        stats.regWrites[addr]++;
+    }
+    wrPos++;
+    return 0;
+}
+
+
+static uint8_t bus_read(void *ctx, uint8_t ack)
+{
+    uint8_t addr = (STATUSRSSI + (rdPos >> 1)) & 0x0f;
+    uint8_t data;
+
+    (void)ctx;
+    (void)ack;
+    stats.readBytes++;
+    if (!(rdPos & 1)) {
+        update();                                   // word latched with its high byte
+        data = reg[addr] >> 8;
+        rdLow = reg[addr];
+    } else {
+        data = rdLow;
+        stats.regReads[addr]++;
+    }
+    rdPos++;
+    return data;
+}
+
+
+static const hal_native_twi_device_t device = {
+    SI4703_SIM_ADDR, bus_start, bus_write, bus_read, NULL, NULL
+};
+
+
+static void print_stats(void)
+{
+    fprintf(stderr, "si4703: %lu transactions, %lu bytes read, %lu written,"
+                    " %lu on the bus with addresses\n",
+            (unsigned long)stats.transactions, (unsigned long)stats.readBytes,
+            (unsigned long)stats.writeBytes,
+            (unsigned long)(stats.transactions + stats.readBytes + stats.writeBytes));
+    for (uint8_t i = 0; i < 16; i++) {
+        if (stats.regReads[i] || stats.regWrites[i])
+            fprintf(stderr, "si4703: reg %02X %8lu reads %8lu writes\n", i,
+                    (unsigned long)stats.regReads[i], (unsigned long)stats.regWrites[i]);
+    }
+    fprintf(stderr, "si4703: %lu tunes, %lu seeks, %lu RDS groups\n",
+            (unsigned long)stats.tunes, (unsigned long)stats.seeks,
+            (unsigned long)stats.groups);
+}
+
+
+/*
+ * Process setup: reset values, the landscape from the factory presets,
+ * and the environment.
+ */
+__attribute__((constructor))
+static void si4703_sim_init(void)
+{
+    const char *env;
+
+    reg[DEVICEID] = DEVICEID_RESET;
+    reg[CHIPID] = CHIPID_OFF;
+    reg[TEST1] = TEST1_RESET;
+
+    for (uint8_t ch = 0; ch < SI4703_SIM_CHANNELS; ch++)
+        land[ch] = noise(LAND_START + ch * 10);
+    for (uint8_t i = 0; i < presets_factory_count(); i++) {
+        int freq = presets_factory_get(i);
+        uint8_t rssi = 35 + i * 13 % 30;
+        si4703_sim_set_channel(freq, rssi, 1, 0x2201 + i);
+    }
+    for (uint8_t i = 0; i < presets_factory_count(); i++) {
+        int freq = presets_factory_get(i);
+        for (int d = -10; d <= 10; d += 20) {
+            si4703_sim_channel_t c = si4703_sim_get_channel(freq + d);
+            uint8_t spill = si4703_sim_get_channel(freq).rssi / 3;
+            if (!c.pi && c.rssi < spill) si4703_sim_set_channel(freq + d, spill, 0, 0);
+        }
+    }
+
+    if ((env = getenv("HAL_SI4703_BLER")) != NULL)
+        si4703_sim_set_bler(atoi(env));
+    if ((env = getenv("HAL_SI4703_STATS")) != NULL && atoi(env))
+        atexit(print_stats);
+    if ((env = getenv("HAL_SI4703")) == NULL || atoi(env))
+        hal_native_twi_attach(&device);
+}
+
+
+// -- Function definitions -------------------------------------------
+void si4703_sim_set_channel(int freq, uint8_t rssi, uint8_t stereo, uint16_t pi)
+{
+    if (freq < LAND_START || (freq - LAND_START) % 10) return;
+    if ((freq - LAND_START) / 10 >= SI4703_SIM_CHANNELS) return;
+
+    si4703_sim_channel_t *c = &land[(freq - LAND_START) / 10];
+    c->rssi = rssi;
+    c->stereo = stereo != 0;
+    c->pi = pi;
+}
+
+
+si4703_sim_channel_t si4703_sim_get_channel(int freq)
+{
+    if (freq < LAND_START || (freq - LAND_START) % 10) return noise(freq);
+    if ((freq - LAND_START) / 10 >= SI4703_SIM_CHANNELS) return noise(freq);
+    return land[(freq - LAND_START) / 10];
+}
+
+
+void si4703_sim_set_bler(uint8_t percent)
+{
+    blerPercent = percent > 100 ? 100 : percent;
+}
+
+
+const si4703_sim_stats_t *si4703_sim_stats(void)
+{
+    return &stats;
+}
+
+
+void si4703_sim_stats_reset(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef SI4703_SIM_H
+# define SI4703_SIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @defgroup si4703_sim Simulated Si4703 tuner <si4703_sim.h>
+ * @code #include <si4703_sim.h> @endcode
+ *
+ * @brief Register model of the Si4703 on the TWI bus of the host build.
+ *
+ * The model answers at address 0x10 like the chip in 2-wire mode:
+ *
+ *   - A read always starts at register 0x0A and runs 0x0A..0x0F, 0x00..
+ *     0x09, high byte first, as getShadow() expects. A write always
+ *     starts at 0x02; a register takes effect with its low byte.
+ *     0x0A..0x0F are read only, writes to them are acknowledged and lost.
+ *   - XOSCEN and ENABLE power the chip up, ENABLE with DISABLE powers it
+ *     down and clears ENABLE.
+ *   - Setting TUNE tunes CHAN in SI4703_SIM_TUNE_MS, then sets STC with
+ *     READCHAN, RSSI and ST of the channel. Setting SEEK steps one
+ *     channel per SI4703_SIM_SEEK_MS in the SEEKUP direction, READCHAN
+ *     following, until a channel reaches SEEKTH. At a band edge it stops
+ *     with SFBL (SKMODE stop) or wraps; back at the start channel it
+ *     stops with SFBL. Clearing TUNE or SEEK clears STC and SFBL.
+ *   - BAND and SPACE select the channel grid; a frequency off the
+ *     100 kHz grid of the landscape is noise.
+ *   - With RDS enabled, a tuned station with a PI sends a group every
+ *     SI4703_SIM_GROUP_US: 0A (PS name) and 2A (radiotext) alternating.
+ *     RDSS is set from the second group on, RDSR for 40 ms per group.
+ *     Each block gets an error level at the configured rate; level 3
+ *     blocks are corrupted. In standard mode (RDSM = 0) groups with a
+ *     level 3 block are not reported, in verbose mode all are.
+ *
+ * State changes are worked out from hal_native_cycles() when the bus
+ * touches the chip, so the timing is exact to the cycle. The reset pin
+ * is not watched; the driver configures every register it uses anyway.
+ *
+ * The landscape covers 87.5-108 MHz at 100 kHz. By default every factory
+ * preset is a stereo station with a PI, the channels next to it carry
+ * some of its signal and the rest is noise below the seek threshold.
+ *
+ * Every byte on the bus to the chip is counted, address bytes included,
+ * with the registers it read or wrote, so the bus cost of the driver can
+ * be compared exactly between builds.
+ *
+ * Environment variables of the process:
+ *   - HAL_SI4703: 0 to leave the bus empty (no tuner)
+ *   - HAL_SI4703_BLER: percentage of RDS blocks with errors
+ *   - HAL_SI4703_STATS: non-zero to print the bus counters to stderr at
+ *     exit
+ * @{
+ */
+
+// -- Includes -------------------------------------------------------
+#include <stdint.h>
+
+
+// -- Defines --------------------------------------------------------
+#define SI4703_SIM_ADDR         0x10    /**< @brief 7-bit TWI address */
+#define SI4703_SIM_CHANNELS     206     /**< @brief Landscape, 87.5-108 MHz */
+#define SI4703_SIM_TUNE_MS      60      /**< @brief Tune time */
+#define SI4703_SIM_SEEK_MS      60      /**< @brief Seek time per channel */
+#define SI4703_SIM_GROUP_US     87600   /**< @brief RDS group period */
+#define SI4703_SIM_RDSR_MS      40      /**< @brief RDSR set per group */
+
+
+// -- Types ----------------------------------------------------------
+/** @brief One channel of the landscape */
+typedef struct {
+    uint8_t rssi;                       /**< @brief dBuV */
+    uint8_t stereo;                     /**< @brief Pilot present */
+    uint16_t pi;                        /**< @brief RDS PI, 0 for no RDS */
+} si4703_sim_channel_t;
+
+/** @brief Bus counters */
+typedef struct {
+    uint32_t transactions;              /**< @brief START + address */
+    uint32_t readBytes;                 /**< @brief Data bytes to the master */
+    uint32_t writeBytes;                /**< @brief Data bytes from the master */
+    uint32_t regReads[16];              /**< @brief Complete words per register */
+    uint32_t regWrites[16];             /**< @brief Complete words per register */
+    uint32_t tunes;                     /**< @brief Tunes started */
+    uint32_t seeks;                     /**< @brief Seeks started */
+    uint32_t groups;                    /**< @brief RDS groups sent */
+} si4703_sim_stats_t;
+
+
+// -- Function prototypes --------------------------------------------
+/**
+ * @brief  Set one channel of the landscape.
+ * @param  freq Frequency in 10 kHz (8750..10800)
+ * @param  rssi Signal in dBuV, 0..75
+ * @param  stereo Non-zero for a stereo station
+ * @param  pi RDS program identification, 0 for none
+ * @return none
+ */
+void si4703_sim_set_channel(int freq, uint8_t rssi, uint8_t stereo, uint16_t pi);
+
+
+/**
+ * @brief  Read one channel of the landscape.
+ * @param  freq Frequency in 10 kHz
+ * @return Channel, noise outside the landscape
+ */
+si4703_sim_channel_t si4703_sim_get_channel(int freq);
+
+
+/**
+ * @brief  Set the RDS block error rate.
+ * @param  percent Blocks with errors, 0..100; a third of them cannot
+ *         be corrected
+ * @return none
+ */
+void si4703_sim_set_bler(uint8_t percent);
+
+
+/**
+ * @brief  Bus counters since the start or the last reset.
+ * @return Counters
+ */
+const si4703_sim_stats_t *si4703_sim_stats(void);
+
+
+/** @brief Clear the bus counters */
+void si4703_sim_stats_reset(void);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
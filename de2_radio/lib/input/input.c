@@ -0,0 +1,147 @@
+/*
+ * Front panel input: timer-sampled buttons with vertical counter
+ * debounce, long-press and accelerating auto-repeat.
+ */
+
+// -- Includes -------------------------------------------------------
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <input.h>
+
+
+// -- Local variables ------------------------------------------------
+static uint8_t scanMask;                // buttons being scanned
+static volatile uint8_t keyState;       // debounced state, 1 = pressed
+static uint8_t ct0 = 0xff, ct1 = 0xff;  // 2-bit vertical counter per button
+static uint8_t scanDiv;
+
+static uint8_t suppress;                // drop events until released
+static uint8_t longSent;                // INPUT_LONG already sent for button
+static uint16_t holdMs[8];              // time held, per bit
+static uint16_t nextRepeatMs[8];        // hold time of the next repeat
+static uint16_t repeatMs[8];            // current repeat interval
+
+static volatile uint8_t queue[INPUT_QUEUE_SIZE];
+static volatile uint8_t queueHead;      // written by ISR
+static volatile uint8_t queueTail;      // written by main loop
+
+#if (INPUT_QUEUE_SIZE & (INPUT_QUEUE_SIZE - 1))
+# error INPUT_QUEUE_SIZE is not a power of 2
+#endif
+
+
+// -- Local functions ------------------------------------------------
+static void input_put(uint8_t type, uint8_t bit)
+{
+    if (suppress & (1 << bit)) {
+        // swallowed press: forget it once the button is up again
+        if (type == INPUT_CLICK || type == INPUT_RELEASE) suppress &= ~(1 << bit);
+        return;
+    }
+    uint8_t head = (queueHead + 1) & (INPUT_QUEUE_SIZE - 1);
+    if (head == queueTail) return;      // full: drop, the main loop is busy
+    queue[head] = type | bit;
+    queueHead = head;
+}
+
+
+/*
+ * Sample all buttons in one byte: PD5..PD7 stay in place, PB0 -> bit 0.
+ * Buttons are active low.
+ */
+static uint8_t input_sample(void)
+{
+    return ~((PIND & 0xE0) | (PINB & 0x01)) & scanMask;
+}
+
+
+// -- Function definitions -------------------------------------------
+void input_init(uint8_t mask)
+{
+    scanMask = mask;
+
+    DDRD  &= ~(mask & 0xE0);
+    PORTD |=  (mask & 0xE0);
+    DDRB  &= ~(mask & 0x01);
+    PORTB |=  (mask & 0x01);
+}
+
+
+void input_tick(void)
+{
+    uint8_t i, changed, pressed, released;
+
+    if (++scanDiv < INPUT_SCAN_MS) return;
+    scanDiv = 0;
+
+    // vertical counter: a bit toggles after 4 samples differing from keyState
+    i = keyState ^ input_sample();
+    ct0 = ~(ct0 & i);
+    ct1 = ct0 ^ (ct1 & i);
+    changed = i & ct0 & ct1;
+    keyState ^= changed;
+
+    pressed  = changed & keyState;
+    released = changed & ~keyState;
+
+    for (uint8_t bit = 0; bit < 8; bit++) {
+        uint8_t m = 1 << bit;
+        if (!(scanMask & m)) continue;
+
+        if (pressed & m) {
+            holdMs[bit] = 0;
+            longSent &= ~m;
+            input_put(INPUT_PRESS, bit);
+        }
+        else if (released & m) {
+            input_put((longSent & m) ? INPUT_RELEASE : INPUT_CLICK, bit);
+        }
+        else if (keyState & m) {
+            holdMs[bit] += INPUT_SCAN_MS;
+            if (!(longSent & m)) {
+                if (holdMs[bit] >= INPUT_LONG_MS) {
+                    longSent |= m;
+                    repeatMs[bit] = INPUT_REPEAT_MS;
+                    nextRepeatMs[bit] = holdMs[bit] + INPUT_REPEAT_MS;
+                    input_put(INPUT_LONG, bit);
+                }
+            }
+            else if (holdMs[bit] >= nextRepeatMs[bit]) {
+                // every repeat comes a quarter sooner, down to the minimum
+                repeatMs[bit] -= repeatMs[bit] / 4;
+                if (repeatMs[bit] < INPUT_REPEAT_MIN_MS) repeatMs[bit] = INPUT_REPEAT_MIN_MS;
+                nextRepeatMs[bit] = holdMs[bit] + repeatMs[bit];
+                if (holdMs[bit] > 60000) {  // keep the counters from wrapping
+                    holdMs[bit] -= 30000;
+                    nextRepeatMs[bit] -= 30000;
+                }
+                input_put(INPUT_REPEAT, bit);
+            }
+        }
+    }
+}
+
+
+uint8_t input_get(void)
+{
+    if (queueHead == queueTail) return INPUT_NONE;
+    uint8_t tail = (queueTail + 1) & (INPUT_QUEUE_SIZE - 1);
+    uint8_t ev = queue[tail];
+    queueTail = tail;
+    return ev;
+}
+
+
+uint8_t input_state(void)
+{
+    return keyState;
+}
+
+
+void input_suppress(void)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        suppress = input_sample() | keyState;
+        queueTail = queueHead;
+    }
+}
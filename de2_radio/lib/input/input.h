@@ -0,0 +1,105 @@
+#ifndef INPUT_H
+# define INPUT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @defgroup input Front panel input <input.h>
+ * @code #include <input.h> @endcode
+ *
+ * @brief Non-blocking front panel buttons.
+ *
+ * All buttons (PD5, PD6, PD7, PB0) are sampled together every
+ * INPUT_SCAN_MS from the Timer2 tick, debounced with a 2-bit vertical
+ * counter over the whole sample byte (4 equal samples) and turned into
+ * events in a small queue that the main loop drains with input_get().
+ * Nothing ever waits for a button to be released.
+ * @{
+ */
+
+// -- Includes -------------------------------------------------------
+#include <avr/io.h>
+
+
+// -- Defines --------------------------------------------------------
+/**
+ * @name Button masks (bit positions in the sample byte)
+ */
+#define INPUT_VOL_UP    (1<<0)  /**< @brief PB0 */
+#define INPUT_PREV      (1<<5)  /**< @brief PD5 */
+#define INPUT_NEXT      (1<<6)  /**< @brief PD6 */
+#define INPUT_VOL_DOWN  (1<<7)  /**< @brief PD7 */
+#define INPUT_ALL       (INPUT_VOL_UP | INPUT_PREV | INPUT_NEXT | INPUT_VOL_DOWN)
+
+/**
+ * @name Event types (upper 3 bits of an event, lower 3 bits = button bit number)
+ */
+#define INPUT_NONE      0x00    /**< @brief Queue empty */
+#define INPUT_PRESS     0x20    /**< @brief Button went down */
+#define INPUT_CLICK     0x40    /**< @brief Released before INPUT_LONG_MS */
+#define INPUT_LONG      0x60    /**< @brief Held for INPUT_LONG_MS */
+#define INPUT_REPEAT    0x80    /**< @brief Still held after INPUT_LONG, accelerating */
+#define INPUT_RELEASE   0xA0    /**< @brief Released after INPUT_LONG */
+#define INPUT_TYPE(ev)   ((ev) & 0xE0)   /**< @brief Event type of an event */
+#define INPUT_BUTTON(ev) (1 << ((ev) & 0x07)) /**< @brief Button mask of an event */
+
+/**
+ * @name Timing
+ */
+#define INPUT_SCAN_MS        4      /**< @brief Sample period, debounce = 4 samples */
+#define INPUT_LONG_MS      600      /**< @brief Hold time for INPUT_LONG */
+#define INPUT_REPEAT_MS    400      /**< @brief First auto-repeat interval */
+#define INPUT_REPEAT_MIN_MS 60      /**< @brief Fastest auto-repeat interval */
+#define INPUT_QUEUE_SIZE     8      /**< @brief Event queue length, power of 2 */
+
+
+// -- Function prototypes --------------------------------------------
+/**
+ * @brief  Configure the buttons in mask as inputs with pull-up. They are
+ *         sampled from the system tick (systick_init()).
+ * @param  mask Buttons to scan, e.g. INPUT_ALL
+ * @return none
+ */
+void input_init(uint8_t mask);
+
+
+/**
+ * @brief  Sample and debounce the buttons; called every 1 ms from the
+ *         system tick interrupt.
+ * @return none
+ */
+void input_tick(void);
+
+
+/**
+ * @brief  Take the oldest event from the queue.
+ * @return Event (type | button bit) or INPUT_NONE
+ */
+uint8_t input_get(void);
+
+
+/**
+ * @brief  Debounced state of the buttons.
+ * @return Button masks of the buttons held down
+ */
+uint8_t input_state(void);
+
+
+/**
+ * @brief  Empty the queue and drop all events of the buttons that are
+ *         down now until they are released, e.g. the one that woke the
+ *         radio from standby.
+ * @return none
+ */
+void input_suppress(void);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,170 @@
+/*
+ * Radio state journal: wear-levelled EEPROM ring written from the
+ * EEPROM ready interrupt.
+ */
+
+// -- Includes -------------------------------------------------------
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+#include <util/crc16.h>
+#include <string.h>
+#include <hal.h>
+#include <journal.h>
+#include <presets.h>
+
+#if (JOURNAL_EE_ADDR < PRESETS_EE_ADDR + PRESETS_EE_SIZE)
+# error "journal overlaps the preset list"
+#endif
+#if (JOURNAL_EE_ADDR + JOURNAL_SLOTS * JOURNAL_RECORD) > (E2END + 1)
+# error "journal does not fit into EEPROM"
+#endif
+
+/* Record layout, CRC last so a torn write never validates */
+#define REC_SEQ     0   // uint16_t, little endian
+#define REC_FREQ    2   // int16_t
+#define REC_VOLUME  4
+#define REC_FLAGS   5   // bit 0: mono
+#define REC_PRESET  6
+#define REC_CRC     7
+
+/* Plausible content, anything else is foreign or stale EEPROM data */
+#define FREQ_MIN    PRESET_BAND_START   // 87.5 MHz
+#define FREQ_MAX    10800               // 108 MHz
+#define VOLUME_MAX  15
+
+
+// -- Local variables ------------------------------------------------
+static journal_state_t saved;       // content of the newest record
+static journal_state_t pending;     // last state seen by journal_update
+static uint8_t dirty;               // pending differs from saved
+static uint16_t changedAt;
+
+static uint16_t seq;                // sequence of the newest record
+static uint8_t slot;                // slot of the newest record
+
+static uint8_t record[JOURNAL_RECORD];  // record being written
+static uint16_t wrAddr;
+static uint8_t wrPos;                   // next byte to write
+
+
+// -- Local functions ------------------------------------------------
+static uint8_t journal_crc(const uint8_t *rec)
+{
+    uint8_t crc = 0xff;
+    for (uint8_t i = 0; i < REC_CRC; i++)
+        crc = _crc8_ccitt_update(crc, rec[i]);
+    return crc;
+}
+
+
+static void journal_start(void)
+{
+    seq++;
+    slot = (slot + 1 >= JOURNAL_SLOTS) ? 0 : slot + 1;
+
+    record[REC_SEQ]      = seq & 0xff;
+    record[REC_SEQ + 1]  = seq >> 8;
+    record[REC_FREQ]     = pending.freq & 0xff;
+    record[REC_FREQ + 1] = (uint16_t)pending.freq >> 8;
+    record[REC_VOLUME]   = pending.volume;
+    record[REC_FLAGS]    = pending.mono ? 1 : 0;
+    record[REC_PRESET]   = pending.preset;
+    record[REC_CRC]      = journal_crc(record);
+
+    saved = pending;
+    dirty = 0;
+
+    wrAddr = JOURNAL_EE_ADDR + slot * JOURNAL_RECORD;
+    wrPos = 0;
+    EECR |= (1 << EERIE);           // fires as soon as the EEPROM is ready
+}
+
+
+// -- Function definitions -------------------------------------------
+uint8_t journal_init(journal_state_t *state, uint8_t presets)
+{
+    uint8_t rec[JOURNAL_RECORD];
+    uint8_t found = 0;
+
+    slot = JOURNAL_SLOTS - 1;       // first save goes to slot 0
+    seq = 0;
+
+    for (uint8_t i = 0; i < JOURNAL_SLOTS; i++) {
+        eeprom_read_block(rec, (const void *)(uintptr_t)(JOURNAL_EE_ADDR + i * JOURNAL_RECORD), JOURNAL_RECORD);
+        if (rec[REC_CRC] != journal_crc(rec)) continue;
+
+        journal_state_t r;
+        r.freq   = rec[REC_FREQ] | (rec[REC_FREQ + 1] << 8);
+        r.volume = rec[REC_VOLUME];
+        r.mono   = rec[REC_FLAGS] & 1;
+        r.preset = rec[REC_PRESET];
+        // a CRC8 passes one random record in 256
+        if (r.freq < FREQ_MIN || r.freq > FREQ_MAX || r.volume > VOLUME_MAX
+            || r.preset >= presets) continue;
+
+        uint16_t s = rec[REC_SEQ] | (rec[REC_SEQ + 1] << 8);
+        // serial number compare, the ring spans far less than 32768 saves
+        if (found && (int16_t)(s - seq) <= 0) continue;
+
+        found = 1;
+        seq = s;
+        slot = i;
+        saved = r;
+    }
+
+    pending = saved;
+    dirty = 0;
+    if (found) *state = saved;
+    return found;
+}
+
+
+void journal_update(const journal_state_t *state, uint16_t now)
+{
+    if (memcmp(state, &pending, sizeof(pending)) != 0) {
+        pending = *state;
+        changedAt = now;
+        dirty = (memcmp(&pending, &saved, sizeof(saved)) != 0);
+    }
+
+    if (dirty && !journal_busy() && (uint16_t)(now - changedAt) >= JOURNAL_QUIET_MS)
+        journal_start();
+}
+
+
+void journal_commit(void)
+{
+    if (dirty && !journal_busy()) journal_start();
+}
+
+
+void journal_flush(void)
+{
+    while (journal_busy()) hal_spin();
+    journal_commit();
+    while (journal_busy()) hal_spin();
+}
+
+
+uint8_t journal_busy(void)
+{
+    // the ISR disables itself once the last byte has been programmed
+    return (EECR & (1 << EERIE)) != 0;
+}
+
+
+/*
+ * One byte per interrupt. Bytes that already hold the value are skipped,
+ * so a record rewritten with little change costs fewer cell writes.
+ */
+ISR(EE_READY_vect)
+{
+    while (wrPos < JOURNAL_RECORD) {
+        uint8_t pos = wrPos++;
+        if (hal_ee_read(wrAddr + pos) != record[pos]) {
+            hal_ee_write(wrAddr + pos, record[pos]);
+            return;
+        }
+    }
+    EECR &= ~(1 << EERIE);
+}
@@ -0,0 +1,99 @@
+#ifndef JOURNAL_H
+# define JOURNAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @defgroup journal Radio state journal <journal.h>
+ * @code #include <journal.h> @endcode
+ *
+ * @brief Last station, volume, mono and preset kept in an EEPROM ring.
+ *
+ * Every save goes to the next of JOURNAL_SLOTS records, so the cells wear
+ * JOURNAL_SLOTS times slower than a fixed location. A record carries a
+ * sequence number and a CRC8 written as its last byte; on boot the valid
+ * record with the highest sequence wins, a torn write is simply ignored.
+ *
+ * A save starts only after the state has been stable for JOURNAL_QUIET_MS.
+ * The bytes are written one by one from the EEPROM ready interrupt, so the
+ * main loop never waits for the 3.3 ms cell write. Unchanged bytes are not
+ * rewritten.
+ * @{
+ */
+
+// -- Includes -------------------------------------------------------
+#include <stdint.h>
+
+
+// -- Defines --------------------------------------------------------
+#define JOURNAL_EE_ADDR  0x080  /**< @brief First EEPROM byte of the ring */
+#define JOURNAL_RECORD       8  /**< @brief Bytes per record */
+#define JOURNAL_SLOTS      112  /**< @brief Records in the ring (to end of EEPROM) */
+#define JOURNAL_QUIET_MS  3000  /**< @brief Stable time before a save */
+
+
+// -- Types ----------------------------------------------------------
+/** @brief State restored at boot */
+typedef struct {
+    int16_t freq;       /**< @brief Tuned frequency, 10 kHz units */
+    uint8_t volume;     /**< @brief 0-15 */
+    uint8_t mono;       /**< @brief 1 = forced mono */
+    uint8_t preset;     /**< @brief Selected preset index */
+} journal_state_t;
+
+
+// -- Function prototypes --------------------------------------------
+/**
+ * @brief  Find the newest valid record. A record only counts with the
+ *         frequency in 87.5-108 MHz, the volume at most 15 and the preset
+ *         below presets; others are treated as foreign data.
+ * @param  state Filled with the stored state if one is found
+ * @param  presets Number of valid values of the preset field
+ * @return 1 if a record was found, 0 if the EEPROM holds none
+ */
+uint8_t journal_init(journal_state_t *state, uint8_t presets);
+
+
+/**
+ * @brief  Report the current state; starts a background save once it
+ *         differs from the stored one and has been stable long enough.
+ *         Call from the main loop.
+ * @param  state Current state
+ * @param  now Time in ms, e.g. millis()
+ * @return none
+ */
+void journal_update(const journal_state_t *state, uint16_t now);
+
+
+/**
+ * @brief  Start saving a pending change now, without the quiet period
+ *         and without waiting. Does nothing while a save is running.
+ * @return none
+ */
+void journal_commit(void);
+
+
+/**
+ * @brief  Save a pending change now and wait until it is written,
+ *         e.g. before power down. Needs interrupts enabled.
+ * @return none
+ */
+void journal_flush(void);
+
+
+/**
+ * @brief  Background write in progress.
+ * @return 1 while the EEPROM ready interrupt is writing a record
+ */
+uint8_t journal_busy(void);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,89 @@
+/*
+ * Deferred logging: messages are queued as format ID plus arguments and
+ * formatted (or sent as telemetry) from the main loop.
+ */
+
+// -- Includes -------------------------------------------------------
+#include <avr/io.h>
+#include <stdio.h>
+#include <util/atomic.h>
+#include <log.h>
+#include <ring.h>
+#include <systick.h>
+#include <telemetry.h>
+#include <uart.h>
+
+
+// -- Types ----------------------------------------------------------
+struct LogEntry {
+    const char *fmt;        // PROGMEM, the message ID
+    uint16_t time;          // millis() when queued, low 16 bits
+    uint16_t arg[2];
+    uint8_t level;
+};
+
+
+// -- Local variables ------------------------------------------------
+static Ring<LogEntry, LOG_QUEUE> queue;
+static volatile uint16_t dropped;
+static const char levelChars[] PROGMEM = "?EWID";
+
+
+// -- Function definitions -------------------------------------------
+void log_write(uint8_t level, const char *fmt, uint16_t a, uint16_t b)
+{
+    LogEntry e;
+    e.fmt = fmt;
+    e.time = millis();
+    e.arg[0] = a;
+    e.arg[1] = b;
+    e.level = level;
+
+    // the ring has one producer side; ISRs and the main loop take turns
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (!queue.push(e)) dropped++;
+    }
+}
+
+
+uint8_t log_drain(void)
+{
+    LogEntry e;
+    if (!queue.peek(e)) return 0;
+
+    if (telemetry_enabled()) {
+        if (uart_tx_free() < 24) return 0;     // a framed TLM_LOG, try later
+        uint16_t id = (uint16_t)(uintptr_t)e.fmt;
+        uint8_t rec[9] = {
+            (uint8_t)id, (uint8_t)(id >> 8), e.level,
+            (uint8_t)e.time, (uint8_t)(e.time >> 8),
+            (uint8_t)e.arg[0], (uint8_t)(e.arg[0] >> 8),
+            (uint8_t)e.arg[1], (uint8_t)(e.arg[1] >> 8)
+        };
+        if (!telemetry_send(TLM_LOG, rec, sizeof(rec))) return 0;
+    }
+    else {
+        char line[LOG_LINE_MAX];
+        line[0] = pgm_read_byte(&levelChars[e.level < 5 ? e.level : 0]);
+        line[1] = ' ';
+        int len = snprintf_P(line + 2, sizeof(line) - 3, e.fmt, e.arg[0], e.arg[1]);
+        if (len > (int)sizeof(line) - 4) len = sizeof(line) - 4;   // truncated
+        len += 2;
+        line[len++] = '\n';
+
+        if (uart_tx_free() < len) return 0;    // try again later
+        uart_write(line, len);
+    }
+    queue.pop(e);
+    return 1;
+}
+
+
+uint16_t log_dropped(void)
+{
+    uint16_t n;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        n = dropped;
+    }
+    return n;
+}
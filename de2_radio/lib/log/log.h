@@ -0,0 +1,100 @@
+#ifndef LOG_H
+# define LOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @defgroup log Deferred logging <log.h>
+ * @code #include <log.h> @endcode
+ *
+ * @brief Levelled log messages with PROGMEM formats and deferred output.
+ *
+ *     LOG_INFO("Tuned to %u", freq);
+ *     LOG_DEBUG("encoder %u", pos);      // gone unless LOG_LEVEL >= 4
+ *
+ * The format is a printf string of up to two 16-bit integer conversions
+ * (%u %d %x). It is placed in flash, and its flash address is the message
+ * ID. A call below LOG_LEVEL (build flag, default LOG_LEVEL_INFO) compiles
+ * to nothing; a call at or above it only queues the ID, the level, the
+ * time and the two arguments, a few dozen cycles, and may come from an
+ * ISR.
+ *
+ * log_drain(), called from the main loop while no task is due, outputs one
+ * queued message per call: formatted as text on the console, or as a
+ * TLM_LOG record while telemetry is on, resolved by tools/tlm2csv.py from
+ * the firmware ELF. When the queue is full new messages are dropped and
+ * counted.
+ * @{
+ */
+
+// -- Includes -------------------------------------------------------
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+
+// -- Defines --------------------------------------------------------
+#define LOG_LEVEL_NONE   0
+#define LOG_LEVEL_ERROR  1
+#define LOG_LEVEL_WARN   2
+#define LOG_LEVEL_INFO   3
+#define LOG_LEVEL_DEBUG  4
+
+#ifndef LOG_LEVEL
+# define LOG_LEVEL LOG_LEVEL_INFO   /**< @brief Highest level compiled in */
+#endif
+
+#define LOG_QUEUE        8      /**< @brief Messages waiting for output */
+#define LOG_LINE_MAX    48      /**< @brief Longest formatted text line */
+
+/** @brief Queue a message at a level, see LOG_INFO() */
+#define LOG_AT(level, fmt, ...)                                     \
+    do {                                                            \
+        if ((level) <= LOG_LEVEL) {                                 \
+            static const char log_fmt_[] PROGMEM = fmt;             \
+            LOG_WRITE_(level, log_fmt_, ##__VA_ARGS__, 0, 0);       \
+        }                                                           \
+    } while (0)
+#define LOG_WRITE_(level, fmt, a, b, ...) \
+    log_write(level, fmt, (uint16_t)(a), (uint16_t)(b))
+
+#define LOG_ERROR(fmt, ...) LOG_AT(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#define LOG_WARN(fmt, ...)  LOG_AT(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#define LOG_INFO(fmt, ...)  LOG_AT(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define LOG_DEBUG(fmt, ...) LOG_AT(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+
+
+// -- Function prototypes --------------------------------------------
+/**
+ * @brief  Queue a message, use the LOG_ macros instead. ISR safe.
+ * @param  level LOG_LEVEL_ERROR .. LOG_LEVEL_DEBUG
+ * @param  fmt Format in program memory
+ * @param  a First argument
+ * @param  b Second argument
+ * @return none
+ */
+void log_write(uint8_t level, const char *fmt, uint16_t a, uint16_t b);
+
+
+/**
+ * @brief  Output the oldest queued message if the UART has room for it.
+ * @return 1 if a message was output
+ */
+uint8_t log_drain(void);
+
+
+/**
+ * @brief  Messages dropped because the queue was full.
+ * @return Count since reset
+ */
+uint16_t log_dropped(void);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
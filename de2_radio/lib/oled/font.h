@@ -130,18 +130,65 @@ const char special_char[][2] PROGMEM = {
     // be sure that last element of this
     // array are {0xff, 0xff} and first element
     // are {first special char, first element after normal char-set in font}
-    {'ü', 95},  // special_char[0]
-    {'Ü', 96},
-    {'ä', 97},
-    {'Ä', 98},
-    {'ö', 99},
-    {'Ö', 100},
-    {'°', 101},
-    {'ß', 102},
-    {'µ', 103},
-    {'ω', 104},
-    {'Ω', 105},
+    // the char is the last byte of its UTF-8 sequence, which is what a
+    // multi-character constant like 'ü' used to be truncated to
+    {0xBC, 95},  // special_char[0], ü
+    {0x9C, 96},  // Ü
+    {0xA4, 97},  // ä
+    {0x84, 98},  // Ä
+    {0xB6, 99},  // ö
+    {0x96, 100}, // Ö
+    {0xB0, 101}, // °
+    {0x9F, 102}, // ß
+    {0xB5, 103}, // µ
+    {0x89, 104}, // ω
+    {0xA9, 105}, // Ω
     {0xff, 0xff} // end of table special_char
 };
 
+// 12x24 digits for big numeric readouts, stored column-major in display
+// page layout [glyph][page][column]: every page is one straight copy into RAM
+// glyphs: 0-9, '.', ' ', '-'
+const uint8_t ssd1306oled_bigdigits[][3][12] PROGMEM = {
+    {{0xFC, 0xFC, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0xFC, 0xFC, 0x00},
+     {0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00},
+     {0x3F, 0x3F, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x3F, 0x3F, 0x00}}, // 0
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFC, 0xFC, 0x00},
+     {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00},
+     {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F, 0x00}}, // 1
+    {{0x00, 0x00, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0xFC, 0xFC, 0x00},
+     {0xF0, 0xF0, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x0F, 0x0F, 0x00},
+     {0x3F, 0x3F, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x00, 0x00, 0x00}}, // 2
+    {{0x00, 0x00, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0xFC, 0xFC, 0x00},
+     {0x00, 0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x00},
+     {0x00, 0x00, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x3F, 0x3F, 0x00}}, // 3
+    {{0xFC, 0xFC, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFC, 0xFC, 0x00},
+     {0x0F, 0x0F, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x00},
+     {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F, 0x00}}, // 4
+    {{0xFC, 0xFC, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x00, 0x00, 0x00},
+     {0x0F, 0x0F, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xF0, 0xF0, 0x00},
+     {0x00, 0x00, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x3F, 0x3F, 0x00}}, // 5
+    {{0xFC, 0xFC, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x00, 0x00, 0x00},
+     {0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xF0, 0xF0, 0x00},
+     {0x3F, 0x3F, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x3F, 0x3F, 0x00}}, // 6
+    {{0x00, 0x00, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0xFC, 0xFC, 0x00},
+     {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00},
+     {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F, 0x00}}, // 7
+    {{0xFC, 0xFC, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0xFC, 0xFC, 0x00},
+     {0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x00},
+     {0x3F, 0x3F, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x3F, 0x3F, 0x00}}, // 8
+    {{0xFC, 0xFC, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0xFC, 0xFC, 0x00},
+     {0x0F, 0x0F, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x00},
+     {0x00, 0x00, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x3F, 0x3F, 0x00}}, // 9
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+     {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+     {0x00, 0x00, 0x00, 0x00, 0x70, 0x70, 0x70, 0x00, 0x00, 0x00, 0x00, 0x00}}, // .
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+     {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+     {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}, // sp
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+     {0x00, 0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00},
+     {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}   // -
+};
+
 #endif
@@ -0,0 +1,72 @@
+/*
+ *  Generated by tools/bmp2rle.py - do not edit, regenerate instead.
+ *  Format: see oled_drawBitmap_rle() in oled.c
+ */
+#ifndef ICONS_H
+# define ICONS_H
+# include <avr/pgmspace.h>
+
+// 128x64, 274 bytes (raw 1024), 94 tokens
+const uint8_t rle_splash[] PROGMEM = {
+    0x80, 0x08, 0x00, 0xFF, 0xFF, 0x01, 0xFD, 0x01, 0x01, 0xFF, 0xFF, 0x90, 0x01, 0xFC, 0xFC, 0xC7,
+    0x0C, 0x81, 0x09, 0xFC, 0xFC, 0x30, 0x30, 0xC0, 0xC0, 0x30, 0x30, 0xFC, 0xFC, 0x8D, 0x01, 0xFC,
+    0xFC, 0xC5, 0x0C, 0x01, 0xF0, 0xF0, 0x81, 0x09, 0xC0, 0xC0, 0x30, 0x30, 0x0C, 0x0C, 0x30, 0x30,
+    0xC0, 0xC0, 0x81, 0x01, 0xFC, 0xFC, 0xC3, 0x0C, 0x03, 0x30, 0x30, 0xC0, 0xC0, 0x83, 0x05, 0x0C,
+    0x0C, 0xFC, 0xFC, 0x0C, 0x0C, 0x83, 0x01, 0xF0, 0xF0, 0xC5, 0x0C, 0x01, 0xF0, 0xF0, 0x8E, 0x01,
+    0xFF, 0xFF, 0x90, 0x01, 0xFF, 0xFF, 0xC5, 0x03, 0x83, 0x01, 0xFF, 0xFF, 0x81, 0x01, 0x03, 0x03,
+    0x81, 0x01, 0xFF, 0xFF, 0x8D, 0x09, 0xFF, 0xFF, 0x03, 0x03, 0x0F, 0x0F, 0x33, 0x33, 0xC0, 0xC0,
+    0x81, 0x01, 0xFF, 0xFF, 0xC5, 0x0C, 0x01, 0xFF, 0xFF, 0x81, 0x01, 0xFF, 0xFF, 0xC3, 0xC0, 0x03,
+    0x30, 0x30, 0x0F, 0x0F, 0x83, 0x05, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0x83, 0x01, 0x3F, 0x3F,
+    0xC5, 0xC0, 0x01, 0x3F, 0x3F, 0x8E, 0x01, 0xFF, 0xFF, 0xBF, 0xBD, 0x01, 0xFF, 0xFF, 0xAD, 0x00,
+    0x18, 0xC2, 0x24, 0x00, 0xC4, 0x81, 0x01, 0x10, 0xF4, 0x82, 0x16, 0x60, 0x50, 0x48, 0xFC, 0x40,
+    0x00, 0x04, 0xC4, 0x24, 0x14, 0x0C, 0x00, 0xF8, 0x44, 0x24, 0x14, 0xF8, 0x00, 0x84, 0x04, 0x14,
+    0x2C, 0xC4, 0xAC, 0x01, 0xFF, 0xFF, 0xAD, 0xC3, 0x01, 0x82, 0xC2, 0x01, 0x84, 0x00, 0x01, 0x82,
+    0x00, 0x01, 0x84, 0xC2, 0x01, 0x82, 0xC2, 0x01, 0xAD, 0x01, 0xFF, 0xFF, 0xA7, 0x06, 0x7F, 0x41,
+    0x41, 0x22, 0x1C, 0x00, 0x7F, 0xC2, 0x49, 0x06, 0x41, 0x00, 0x42, 0x61, 0x51, 0x49, 0x46, 0x86,
+    0x12, 0x42, 0x61, 0x51, 0x49, 0x46, 0x00, 0x3E, 0x51, 0x49, 0x45, 0x3E, 0x00, 0x42, 0x61, 0x51,
+    0x49, 0x46, 0x00, 0x27, 0xC2, 0x45, 0x00, 0x39, 0xA6, 0x01, 0xFF, 0xFF, 0xFF, 0x80, 0xFD, 0x80,
+    0x00, 0xFF,
+};
+
+// 12x8, 15 bytes (raw 12), 1 tokens
+const uint8_t rle_stereo[] PROGMEM = {
+    0x0C, 0x01, 0x0B, 0x18, 0x7E, 0x42, 0xC3, 0xDB, 0x7E, 0x7E, 0xDB, 0xC3, 0x42, 0x7E, 0x18,
+};
+
+// 12x8, 3 bytes (raw 12), 1 tokens
+const uint8_t rle_mono[] PROGMEM = {
+    0x0C, 0x01, 0x8B,
+};
+
+// 18x8, 21 bytes (raw 18), 3 tokens
+const uint8_t rle_rds[] PROGMEM = {
+    0x12, 0x01, 0x0D, 0x00, 0x7F, 0x09, 0x19, 0x29, 0x46, 0x00, 0x7F, 0x41, 0x41, 0x22, 0x1C, 0x00,
+    0x46, 0xC2, 0x49, 0x00, 0x31,
+};
+
+// 11x8, 14 bytes (raw 11), 1 tokens
+const uint8_t rle_signal_0[] PROGMEM = {
+    0x0B, 0x01, 0x0A, 0x80, 0x80, 0x00, 0x80, 0x80, 0x00, 0x80, 0x80, 0x00, 0x80, 0x80,
+};
+
+// 11x8, 14 bytes (raw 11), 1 tokens
+const uint8_t rle_signal_1[] PROGMEM = {
+    0x0B, 0x01, 0x0A, 0xC0, 0xC0, 0x00, 0x80, 0x80, 0x00, 0x80, 0x80, 0x00, 0x80, 0x80,
+};
+
+// 11x8, 14 bytes (raw 11), 1 tokens
+const uint8_t rle_signal_2[] PROGMEM = {
+    0x0B, 0x01, 0x0A, 0xC0, 0xC0, 0x00, 0xF0, 0xF0, 0x00, 0x80, 0x80, 0x00, 0x80, 0x80,
+};
+
+// 11x8, 14 bytes (raw 11), 1 tokens
+const uint8_t rle_signal_3[] PROGMEM = {
+    0x0B, 0x01, 0x0A, 0xC0, 0xC0, 0x00, 0xF0, 0xF0, 0x00, 0xFC, 0xFC, 0x00, 0x80, 0x80,
+};
+
+// 11x8, 14 bytes (raw 11), 1 tokens
+const uint8_t rle_signal_4[] PROGMEM = {
+    0x0B, 0x01, 0x0A, 0xC0, 0xC0, 0x00, 0xF0, 0xF0, 0x00, 0xFC, 0xFC, 0x00, 0xFF, 0xFF,
+};
+
+#endif
@@ -50,6 +50,7 @@
 
 #if defined SPI
 # include <util/delay.h>
+# include <avr/interrupt.h>
 #endif
 
 static struct {
@@ -57,10 +58,40 @@ static struct {
     uint8_t y;
 } cursorPosition;
 
+// where the next oled_data() has to land (set by goto, advanced by data)
+static struct {
+    uint8_t x;
+    uint8_t y;
+} ramTarget;
+
+// where the controller's RAM pointer is known to be (valid == 0: unknown)
+static struct {
+    uint8_t x;
+    uint8_t y;
+    uint8_t valid;
+} ramPointer;
+
+static uint8_t busOpen;             // transaction (START / CS low) in progress
+static uint16_t busTransactions;    // START conditions / CS frames since init
+
 static uint8_t charMode = NORMALSIZE;
 #if defined GRAPHICMODE
 # include <stdlib.h>
 static uint8_t displayBuffer[DISPLAY_HEIGHT/8][DISPLAY_WIDTH];
+// changed columns per line since the last flush: [dirtyFrom, dirtyTo)
+static uint8_t dirtyFrom[DISPLAY_HEIGHT/8];
+static uint8_t dirtyTo[DISPLAY_HEIGHT/8];
+#if defined SPI
+// spans handed to the SPI_STC_vect streamer by oled_display_dirty()
+static uint8_t spanFrom[DISPLAY_HEIGHT/8];
+static uint8_t spanTo[DISPLAY_HEIGHT/8];
+static volatile uint8_t spanLine = DISPLAY_HEIGHT/8;  // line being streamed, DISPLAY_HEIGHT/8 = idle
+static uint8_t spanCmd[5];
+static uint8_t spanCmdLen;
+static uint8_t spanCmdPos;
+static const uint8_t *spanData;
+static uint8_t spanDataLeft;
+#endif
 #elif defined TEXTMODE
 #else
 # error "No valid displaymode! Refer oled.h"
@@ -98,50 +129,123 @@ const uint8_t init_sequence [] PROGMEM = {    // Initialization Sequence
     0x8D, 0x14,      // Set DC-DC enable
 };
 // #pragma mark LCD COMMUNICATION
-void oled_command(uint8_t cmd[], uint8_t size) {
+// Commands and data are batched into as few bus transactions as possible:
+// on I2C every command is sent as control byte 0x80 (Co=1, D/C#=0) + command
+// inside one transaction, the data run follows with control byte 0x40 (Co=0)
+// and closes the transaction. Addressing is only sent when the controller's
+// RAM pointer is not already at the target.
+static uint8_t oled_address_sequence(uint8_t x, uint8_t y, uint8_t seq[]) {
+#if defined (SSD1306) || defined (SSD1309)
+    seq[0] = 0xb0+y;
+    seq[1] = 0x21;
+    seq[2] = x;
+    seq[3] = 0x7f;
+    return 4;
+#elif defined SH1106
+    seq[0] = 0xb0+y;
+    seq[1] = 0x21;
+    seq[2] = 0x00+((2+x) & (0x0f));
+    seq[3] = 0x10+( ((2+x) & (0xf0)) >> 4 );
+    seq[4] = 0x7f;
+    return 5;
+#endif
+}
+static void oled_bus_open(void) {
+    if (busOpen) return;
+#if defined SPI && defined GRAPHICMODE
+    while (spanLine != DISPLAY_HEIGHT/8);  // let a running span stream finish
+#endif
 #if defined I2C
     twi_start();
     twi_write((OLED_I2C_ADR<<1) | TWI_WRITE);
-    // i2c_start((OLED_I2C_ADR << 1) | 0);
-    twi_write(0x00);
-    // i2c_byte(0x00);    // 0x00 for command, 0x40 for data
-    for (uint8_t i=0; i<size; i++) {
-        twi_write(cmd[i]);
-        // i2c_byte(cmd[i]);
-    }
+#elif defined SPI
+    OLED_PORT &= ~(1 << CS_PIN);
+#endif
+    busOpen = 1;
+    busTransactions++;
+}
+static void oled_bus_close(void) {
+    if (!busOpen) return;
+#if defined I2C
     twi_stop();
 #elif defined SPI
-	OLED_PORT &= ~(1 << CS_PIN);
-	OLED_PORT &= ~(1 << DC_PIN);
-	for (uint8_t i=0; i<size; i++) {
-        SPDR = cmd[i];
-        while(!(SPSR & (1<<SPIF)));
-    }
     OLED_PORT |= (1 << CS_PIN);
 #endif
+    busOpen = 0;
 }
-void oled_data(uint8_t data[], uint16_t size) {
+static void oled_bus_cmd(uint8_t cmd) {
+    oled_bus_open();
 #if defined I2C
-    twi_start();
-    twi_write((OLED_I2C_ADR<<1) | TWI_WRITE);
-    // i2c_start((OLED_I2C_ADR << 1) | 0);
-    twi_write(0x40);
-    // i2c_byte(0x40);    // 0x00 for command, 0x40 for data
+    twi_write(0x80);    // Co=1: one command byte, another control byte follows
+    twi_write(cmd);
+#elif defined SPI
+    OLED_PORT &= ~(1 << DC_PIN);
+    SPDR = cmd;
+    while(!(SPSR & (1<<SPIF)));
+#endif
+}
+static void oled_bus_data(const uint8_t data[], uint16_t size) {
+    oled_bus_open();
+#if defined I2C
+    twi_write(0x40);    // Co=0: everything up to STOP is display data
     for (uint16_t i = 0; i<size; i++) {
         twi_write(data[i]);
-        // i2c_byte(data[i]);
     }
-    twi_stop();
-    // i2c_stop();
 #elif defined SPI
-	OLED_PORT &= ~(1 << CS_PIN);
-	OLED_PORT |= (1 << DC_PIN);
-	for (uint16_t i = 0; i<size; i++) {
+    OLED_PORT |= (1 << DC_PIN);
+    for (uint16_t i = 0; i<size; i++) {
         SPDR = data[i];
         while(!(SPSR & (1<<SPIF)));
     }
-    OLED_PORT |= (1 << CS_PIN);
 #endif
+    oled_bus_close();
+}
+static void oled_bus_address(void) {
+    uint8_t x = ramTarget.x;
+    uint8_t y = ramTarget.y;
+    if (ramPointer.valid && ramPointer.x == x && ramPointer.y == y) return;
+    // past the end of a line: let the controller continue as it would have
+    if (x >= DISPLAY_WIDTH) return;
+    uint8_t seq[5];
+    uint8_t len = oled_address_sequence(x, y, seq);
+    for (uint8_t i = 0; i < len; i++) {
+        oled_bus_cmd(seq[i]);
+    }
+    ramPointer.x = x;
+    ramPointer.y = y;
+    ramPointer.valid = 1;
+}
+static void oled_set_ram_target(uint8_t x, uint8_t y) {
+    ramTarget.x = x;
+    ramTarget.y = y;
+}
+void oled_command(uint8_t cmd[], uint8_t size) {
+    oled_bus_close();
+    oled_bus_open();
+#if defined I2C
+    twi_write(0x00);    // 0x00 for command stream, 0x40 for data
+    for (uint8_t i=0; i<size; i++) {
+        twi_write(cmd[i]);
+    }
+#elif defined SPI
+	OLED_PORT &= ~(1 << DC_PIN);
+	for (uint8_t i=0; i<size; i++) {
+        SPDR = cmd[i];
+        while(!(SPSR & (1<<SPIF)));
+    }
+#endif
+    oled_bus_close();
+    ramPointer.valid = 0;   // raw commands may have moved the RAM pointer
+}
+void oled_data(uint8_t data[], uint16_t size) {
+    oled_bus_address();
+    oled_bus_data(data, size);
+    ramTarget.x += size;
+    ramPointer.x = ramTarget.x;
+    if (ramPointer.x >= DISPLAY_WIDTH) ramPointer.valid = 0;
+}
+uint16_t oled_transactions(void) {
+    return busTransactions;
 }
 // #pragma mark -
 // #pragma mark GENERAL FUNCTIONS
@@ -151,7 +255,8 @@ void oled_init(uint8_t dispAttr){
     twi_init();
 #elif defined SPI
 	DDRB |= (1 << PB2)|(1 << PB3)|(1 << PB5);
-    SPCR = (1 << SPE)|(1<<MSTR)|(1<<SPR0);
+    SPCR = (1 << SPE)|(1<<MSTR);    // fosc/4 ...
+    SPSR = (1 << SPI2X);            // ... doubled: fosc/2 = 8 MHz
     OLED_DDR |= (1 << CS_PIN)|(1 << DC_PIN)|(1 << RES_PIN);
     OLED_PORT |= (1 << CS_PIN)|(1 << DC_PIN)|(1 << RES_PIN);
     OLED_PORT &= ~(1 << RES_PIN);
@@ -165,7 +270,13 @@ void oled_init(uint8_t dispAttr){
     }
     commandSequence[sizeof(init_sequence)]=(dispAttr);
     oled_command(commandSequence, sizeof(commandSequence));
+#ifdef GRAPHICMODE
+    // no 1 KB clear over the bus: the first oled_display() writes every byte
+    oled_clear_buffer();
+    oled_home();
+#else
     oled_clrscr();
+#endif
 }
 void oled_gotoxy(uint8_t x, uint8_t y){
     x = x * sizeof(FONT[0]);
@@ -175,12 +286,7 @@ void oled_goto_xpix_y(uint8_t x, uint8_t y){
     if( x > (DISPLAY_WIDTH) || y > (DISPLAY_HEIGHT/8-1)) return;// out of display
     cursorPosition.x=x;
     cursorPosition.y=y;
-#if defined (SSD1306) || defined (SSD1309)
-    uint8_t commandSequence[] = {0xb0+y, 0x21, x, 0x7f};
-#elif defined SH1106
-    uint8_t commandSequence[] = {0xb0+y, 0x21, 0x00+((2+x) & (0x0f)), 0x10+( ((2+x) & (0xf0)) >> 4 ), 0x7f};
-#endif
-    oled_command(commandSequence, sizeof(commandSequence));
+    oled_set_ram_target(x, y);  // addressing goes out with the next data
 }
 void oled_clrscr(void){
 #ifdef GRAPHICMODE
@@ -188,6 +294,8 @@ void oled_clrscr(void){
         memset(displayBuffer[i], 0x00, sizeof(displayBuffer[i]));
         oled_gotoxy(0,i);
         oled_data(displayBuffer[i], sizeof(displayBuffer[i]));
+        dirtyFrom[i] = DISPLAY_WIDTH;
+        dirtyTo[i] = 0;
     }
 #elif defined TEXTMODE
     uint8_t displayBuffer[DISPLAY_WIDTH];
@@ -224,6 +332,17 @@ void oled_set_contrast(uint8_t contrast){
     uint8_t commandSequence[2] = {0x81, contrast};
     oled_command(commandSequence, sizeof(commandSequence));
 }
+#ifdef GRAPHICMODE
+static void oled_mark_dirty(uint8_t line, uint8_t x, uint8_t width){
+    if (x < dirtyFrom[line]) dirtyFrom[line] = x;
+    if (x + width > dirtyTo[line]) dirtyTo[line] = x + width;
+}
+static void oled_buffer_put(uint8_t line, uint8_t x, uint8_t pattern){
+    if (displayBuffer[line][x] == pattern) return;
+    displayBuffer[line][x] = pattern;
+    oled_mark_dirty(line, x, 1);
+}
+#endif
 void oled_putc(char c){
     switch (c) {
         case '\b':
@@ -286,10 +405,10 @@ void oled_putc(char c){
                 for (uint8_t i = 0; i < sizeof(FONT[0]); i++)
                 {
                     // load bit-pattern from flash
-                    displayBuffer[cursorPosition.y+1][cursorPosition.x+(2*i)] = doubleChar[i] >> 8;
-                    displayBuffer[cursorPosition.y+1][cursorPosition.x+(2*i)+1] = doubleChar[i] >> 8;
-                    displayBuffer[cursorPosition.y][cursorPosition.x+(2*i)] = doubleChar[i] & 0xff;
-                    displayBuffer[cursorPosition.y][cursorPosition.x+(2*i)+1] = doubleChar[i] & 0xff;
+                    oled_buffer_put(cursorPosition.y+1, cursorPosition.x+(2*i), doubleChar[i] >> 8);
+                    oled_buffer_put(cursorPosition.y+1, cursorPosition.x+(2*i)+1, doubleChar[i] >> 8);
+                    oled_buffer_put(cursorPosition.y, cursorPosition.x+(2*i), doubleChar[i] & 0xff);
+                    oled_buffer_put(cursorPosition.y, cursorPosition.x+(2*i)+1, doubleChar[i] & 0xff);
                 }
                 cursorPosition.x += sizeof(FONT[0])*2;
             } else {
@@ -298,7 +417,7 @@ void oled_putc(char c){
                 for (uint8_t i = 0; i < sizeof(FONT[0]); i++)
                 {
                     // load bit-pattern from flash
-                    displayBuffer[cursorPosition.y][cursorPosition.x+i] =pgm_read_byte(&(FONT[(uint8_t)c][i]));
+                    oled_buffer_put(cursorPosition.y, cursorPosition.x+i, pgm_read_byte(&(FONT[(uint8_t)c][i])));
                 }
                 cursorPosition.x += sizeof(FONT[0]);
             }
@@ -327,19 +446,7 @@ void oled_putc(char c){
                 }
                 oled_data(data, sizeof(FONT[0])*2);
                 
-#if defined (SSD1306) || defined (SSD1309)
-                uint8_t commandSequence[] = {0xb0+cursorPosition.y+1,
-                    0x21,
-                    cursorPosition.x,
-                    0x7f};
-#elif defined SH1106
-                uint8_t commandSequence[] = {0xb0+cursorPosition.y+1,
-                    0x21,
-                    0x00+((2+cursorPosition.x) & (0x0f)),
-                    0x10+( ((2+cursorPosition.x) & (0xf0)) >> 4 ),
-                    0x7f};
-#endif
-                oled_command(commandSequence, sizeof(commandSequence));
+                oled_set_ram_target(cursorPosition.x, cursorPosition.y+1);
                 
                 for (uint8_t i = 0; i < sizeof(FONT[0]); i++)
                 {
@@ -349,14 +456,7 @@ void oled_putc(char c){
                 }
                 oled_data(data, sizeof(FONT[0])*2);
                 
-                commandSequence[0] = 0xb0+cursorPosition.y;
-#if defined (SSD1306) || defined (SSD1309)
-                commandSequence[2] = cursorPosition.x+(2*sizeof(FONT[0]));
-#elif defined SH1106
-                commandSequence[2] = 0x00+((2+cursorPosition.x+(2*sizeof(FONT[0]))) & (0x0f));
-                commandSequence[3] = 0x10+( ((2+cursorPosition.x+(2*sizeof(FONT[0]))) & (0xf0)) >> 4 );
-#endif
-                oled_command(commandSequence, sizeof(commandSequence));
+                oled_set_ram_target(cursorPosition.x+(2*sizeof(FONT[0])), cursorPosition.y);
                 cursorPosition.x += sizeof(FONT[0])*2;
             } else {
                 uint8_t data[sizeof(FONT[0])];
@@ -418,6 +518,89 @@ void oled_puts_p(const char* progmem_s){
         oled_putc(c);
     }
 }
+static uint8_t oled_bigdigit_glyph(char c){
+    if (c >= '0' && c <= '9') return c - '0';
+    switch (c) {
+        case '.': return 10;
+        case ' ': return 11;
+        case '-': return 12;
+        default:  return 0xff;
+    }
+}
+void oled_putc_big(char c){
+    uint8_t glyph = oled_bigdigit_glyph(c);
+    if (glyph == 0xff) return;
+    if ((cursorPosition.x+BIGDIGIT_WIDTH) > DISPLAY_WIDTH) return;
+    if ((cursorPosition.y+BIGDIGIT_LINES) > DISPLAY_HEIGHT/8) return;
+    
+    for (uint8_t i = 0; i < BIGDIGIT_LINES; i++) {
+        const uint8_t *pattern = ssd1306oled_bigdigits[glyph][i];
+#ifdef GRAPHICMODE
+        // glyph pages are already in RAM layout: one copy per line
+        uint8_t *line = &displayBuffer[cursorPosition.y+i][cursorPosition.x];
+        if (memcmp_P(line, pattern, BIGDIGIT_WIDTH) == 0) continue;
+        memcpy_P(line, pattern, BIGDIGIT_WIDTH);
+        oled_mark_dirty(cursorPosition.y+i, cursorPosition.x, BIGDIGIT_WIDTH);
+#elif defined TEXTMODE
+        uint8_t data[BIGDIGIT_WIDTH];
+        memcpy_P(data, pattern, BIGDIGIT_WIDTH);
+        oled_set_ram_target(cursorPosition.x, cursorPosition.y+i);
+        oled_data(data, BIGDIGIT_WIDTH);
+#endif
+    }
+    cursorPosition.x += BIGDIGIT_WIDTH;
+    oled_set_ram_target(cursorPosition.x, cursorPosition.y);
+}
+void oled_puts_big(const char* s){
+    while (*s) {
+        oled_putc_big(*s++);
+    }
+}
+uint8_t oled_drawBitmap_rle(uint8_t x, uint8_t line, const uint8_t *rle){
+    // stream from tools/bmp2rle.py: width, lines, then page-major tokens
+    //   0nnnnnnn     n+1 literal bytes follow
+    //   10nnnnnn     n+1 bytes 0x00
+    //   11nnnnnn vv  n+1 bytes vv
+    uint8_t width = pgm_read_byte(rle++);
+    uint8_t lines = pgm_read_byte(rle++);
+    if ((x+width) > DISPLAY_WIDTH || (line+lines) > DISPLAY_HEIGHT/8) return 1; // out of Display
+#if defined TEXTMODE
+    uint8_t strip[DISPLAY_WIDTH];  // no framebuffer: send every line straight to the bus
+#endif
+    uint8_t count = 0, literal = 0, pattern = 0;
+    uint8_t col = 0;
+    
+    while (lines) {
+        if (count == 0) {
+            uint8_t token = pgm_read_byte(rle++);
+            if (token & 0x80) {
+                literal = 0;
+                count = (token & 0x3f) + 1;
+                pattern = (token & 0x40) ? pgm_read_byte(rle++) : 0x00;
+            } else {
+                literal = 1;
+                count = token + 1;
+            }
+        }
+        if (literal) pattern = pgm_read_byte(rle++);
+        count--;
+#if defined GRAPHICMODE
+        oled_buffer_put(line, x+col, pattern);
+#elif defined TEXTMODE
+        strip[col] = pattern;
+#endif
+        if (++col == width) {
+#if defined TEXTMODE
+            oled_set_ram_target(x, line);
+            oled_data(strip, width);
+#endif
+            col = 0;
+            line++;
+            lines--;
+        }
+    }
+    return 0;
+}
 #ifdef GRAPHICMODE
 // #pragma mark -
 // #pragma mark GRAPHIC FUNCTIONS
@@ -425,9 +608,9 @@ uint8_t oled_drawPixel(uint8_t x, uint8_t y, uint8_t color){
     if( x > DISPLAY_WIDTH-1 || y > (DISPLAY_HEIGHT-1)) return 1; // out of Display
     
     if( color == WHITE){
-        displayBuffer[(y / 8)][x] |= (1 << (y % 8));
+        oled_buffer_put(y / 8, x, displayBuffer[(y / 8)][x] | (1 << (y % 8)));
     } else {
-        displayBuffer[(y / 8)][x] &= ~(1 << (y % 8));
+        oled_buffer_put(y / 8, x, displayBuffer[(y / 8)][x] & ~(1 << (y % 8)));
     }
     
     return 0;
@@ -532,19 +715,123 @@ uint8_t oled_drawBitmap(uint8_t x, uint8_t y, const uint8_t *picture, uint8_t wi
     return result;
 }
 void oled_display() {
-#if defined (SSD1306) || defined (SSD1309)
+#if defined SPI
+    for (uint8_t i = 0; i < DISPLAY_HEIGHT/8; i++){
+        oled_mark_dirty(i, 0, DISPLAY_WIDTH);
+    }
+    oled_display_dirty();
+#elif defined (SSD1306) || defined (SSD1309)
     oled_gotoxy(0,0);
     oled_data(&displayBuffer[0][0], DISPLAY_WIDTH*DISPLAY_HEIGHT/8);
+    for (uint8_t i = 0; i < DISPLAY_HEIGHT/8; i++){
+        dirtyFrom[i] = DISPLAY_WIDTH;
+        dirtyTo[i] = 0;
+    }
 #elif defined SH1106
     for (uint8_t i = 0; i < DISPLAY_HEIGHT/8; i++){
         oled_gotoxy(0,i);
         oled_data(displayBuffer[i], sizeof(displayBuffer[i]));
+        dirtyFrom[i] = DISPLAY_WIDTH;
+        dirtyTo[i] = 0;
+    }
+#endif
+}
+#if defined SPI
+// Load the next span into the streamer, returns 0 when all are sent. The data
+// comes straight from displayBuffer, which must not change until the stream ends.
+static uint8_t oled_span_next(void) {
+    uint8_t line = spanLine;
+    while (++line < DISPLAY_HEIGHT/8) {
+        if (spanFrom[line] < spanTo[line]) {
+            spanLine = line;
+            spanCmdLen = oled_address_sequence(spanFrom[line], line, spanCmd);
+            spanCmdPos = 0;
+            spanData = &displayBuffer[line][spanFrom[line]];
+            spanDataLeft = spanTo[line] - spanFrom[line];
+            return 1;
+        }
+    }
+    spanLine = DISPLAY_HEIGHT/8;
+    return 0;
+}
+// One byte per interrupt: address commands with DC low, then the span with DC high.
+ISR(SPI_STC_vect) {
+    if (spanCmdPos < spanCmdLen) {
+        SPDR = spanCmd[spanCmdPos++];
+        return;
     }
+    if (spanDataLeft) {
+        OLED_PORT |= (1 << DC_PIN);
+        spanDataLeft--;
+        SPDR = *spanData++;
+        return;
+    }
+    OLED_PORT &= ~(1 << DC_PIN);
+    if (oled_span_next()) {
+        SPDR = spanCmd[spanCmdPos++];
+        return;
+    }
+    SPCR &= ~(1 << SPIE);
+    OLED_PORT |= (1 << CS_PIN);
+    ramPointer.valid = 0;
+}
+#endif
+void oled_display_dirty(void) {
+#if defined SPI
+    while (spanLine != DISPLAY_HEIGHT/8);   // previous frame still streaming
+    for (uint8_t i = 0; i < DISPLAY_HEIGHT/8; i++){
+        spanFrom[i] = dirtyFrom[i];
+        spanTo[i] = dirtyTo[i];
+        dirtyFrom[i] = DISPLAY_WIDTH;
+        dirtyTo[i] = 0;
+    }
+    spanLine = 0xff;    // oled_span_next() starts at line 0
+    if (!oled_span_next()) return;
+    // prime the first byte, SPI_STC_vect streams the rest in the background
+    OLED_PORT &= ~(1 << CS_PIN);
+    OLED_PORT &= ~(1 << DC_PIN);
+    busTransactions++;
+    SPCR |= (1 << SPIE);
+    SPDR = spanCmd[spanCmdPos++];
+#else
+    for (uint8_t i = 0; i < DISPLAY_HEIGHT/8; i++){
+        if (dirtyFrom[i] < dirtyTo[i]) {
+            oled_display_block(dirtyFrom[i], i, dirtyTo[i] - dirtyFrom[i]);
+            dirtyFrom[i] = DISPLAY_WIDTH;
+            dirtyTo[i] = 0;
+        }
+    }
+#endif
+}
+uint8_t oled_display_next(void) {
+#if defined SPI
+    oled_display_dirty();
+    return 0;
+#else
+    uint8_t sent = 0;
+    for (uint8_t i = 0; i < DISPLAY_HEIGHT/8; i++){
+        if (dirtyFrom[i] < dirtyTo[i]) {
+            if (sent) return 1;
+            oled_display_block(dirtyFrom[i], i, dirtyTo[i] - dirtyFrom[i]);
+            dirtyFrom[i] = DISPLAY_WIDTH;
+            dirtyTo[i] = 0;
+            sent = 1;
+        }
+    }
+    return 0;
+#endif
+}
+uint8_t oled_display_busy(void) {
+#if defined SPI
+    return spanLine != DISPLAY_HEIGHT/8;
+#else
+    return 0;
 #endif
 }
 void oled_clear_buffer() {
     for (uint8_t i = 0; i < DISPLAY_HEIGHT/8; i++){
         memset(displayBuffer[i], 0x00, sizeof(displayBuffer[i]));
+        oled_mark_dirty(i, 0, DISPLAY_WIDTH);
     }
 }
 uint8_t oled_check_buffer(uint8_t x, uint8_t y) {
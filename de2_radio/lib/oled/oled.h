@@ -100,10 +100,15 @@ extern "C" {
 #define DISPLAY_WIDTH 128
 #define DISPLAY_HEIGHT 64
 
+#define BIGDIGIT_WIDTH 12   // pixel columns of one glyph of the big digit font
+#define BIGDIGIT_LINES 3    // display lines (pages) of one glyph of the big digit font
+
 // Transmit command or data to display
 void oled_command(uint8_t cmd[], uint8_t size);
 void oled_data(uint8_t data[], uint16_t size);
-void oled_init(uint8_t dispAttr);
+uint16_t oled_transactions(void);  // bus transactions (I2C START / SPI CS frames) since init
+void oled_init(uint8_t dispAttr);  // GRAPHICMODE: clears only the buffer, display RAM is
+                                   // undefined until the first oled_display()
 void oled_home(void);  // set cursor to 0,0
 void oled_invert(uint8_t invert);  // invert display
 void oled_sleep(uint8_t sleep);    // display goto sleep (power off)
@@ -121,6 +126,10 @@ void oled_goto_xpix_y(uint8_t x, uint8_t y); // set curser at pos x, y. x means
 void oled_putc(char c);  // print character on screen at TEXTMODE
 // at GRAPHICMODE print character to buffer
 void oled_charMode(uint8_t mode);  // set size of chars
+void oled_putc_big(char c);  // print 12x24 glyph ('0'-'9', '.', ' ', '-') at cursor, 3 lines high
+void oled_puts_big(const char* s);  // print string with the 12x24 digit font
+uint8_t oled_drawBitmap_rle(uint8_t x, uint8_t line, const uint8_t *rle);  // draw RLE bitmap from flash
+// (tools/bmp2rle.py) at pixel column x, line (page) y; GRAPHICMODE into buffer, TEXTMODE straight to display
 void oled_flip(uint8_t flipping);  // flip display, 
                     // flipping == 0: no flip (normal mode) 
                         // == 1: flip horizontal & vertical
@@ -135,6 +144,12 @@ void oled_flip(uint8_t flipping);  // flip display,
     uint8_t oled_fillCircle(uint8_t center_x, uint8_t center_y, uint8_t radius, uint8_t color);
     uint8_t oled_drawBitmap(uint8_t x, uint8_t y, const uint8_t picture[], uint8_t width, uint8_t height, uint8_t color);
     void oled_display(void);       // copy buffer to display RAM
+    void oled_display_dirty(void); // copy only changed spans of the buffer to display RAM
+                                   // (SPI: returns at once, SPI_STC_vect streams in the background
+                                   //  from the buffer; wait for oled_display_busy() before drawing)
+    uint8_t oled_display_next(void); // I2C: send the first dirty span only, 1 while more are left
+                                     // (SPI: same as oled_display_dirty(), returns 0)
+    uint8_t oled_display_busy(void); // 1 while a background span stream is running (SPI only)
     void oled_clear_buffer(void);  // clear display buffer
     uint8_t oled_check_buffer(uint8_t x, uint8_t y); // read a pixel value from the display buffer
     void oled_display_block(uint8_t x, uint8_t line, uint8_t width); // display (part of) a display line
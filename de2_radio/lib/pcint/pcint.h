@@ -0,0 +1,98 @@
+#ifndef PCINT_H
+#define PCINT_H
+
+/*
+ * Pin change interrupt dispatcher.
+ *
+ * One ISR per port (PCINT0 = PORTB, PCINT1 = PORTC, PCINT2 = PORTD) reads
+ * the port once, XORs it with the snapshot of the previous interrupt and
+ * calls the handlers whose pins changed. The handler table is a type, so
+ * every entry becomes a mask test and a direct (usually inlined) call; the
+ * ISR never walks a list of function pointers.
+ *
+ *   typedef PcintTable<
+ *       PcintHandler<FreqPinA::mask | FreqPinB::mask, FreqSelector::pinChange>,
+ *       PcintHandler<0xE0, wakeHandler>
+ *   > PortDTable;
+ *   PCINT_VECTOR(PCINT2_vect, PortD, PortDTable)
+ *
+ * Handlers get the changed bits (already masked to the pins of the table)
+ * and the port snapshot: void handler(uint8_t changed, uint8_t pins).
+ * Pins whose PCMSK bit is off do not raise the interrupt, so changed can
+ * also contain pins that moved while the interrupt was disabled.
+ *
+ * Duration is bounded by construction: each table entry runs at most once
+ * per interrupt. Define PCINT_PROFILE to drive PB5 (Uno D13) high for the
+ * length of each dispatch and measure it with a logic analyser. PB5 is
+ * also SPI SCK, so profile I2C display builds only.
+ *
+ * Enabling the pins (PCMSKx, PCICR) stays with the modules that own them.
+ */
+
+#include <avr/interrupt.h>
+#include <stdint.h>
+#include <pin.h>
+
+template <uint8_t Mask, void (*Fn)(uint8_t changed, uint8_t pins)>
+struct PcintHandler {
+    static constexpr uint8_t mask = Mask;
+    static void call(uint8_t changed, uint8_t pins) { Fn(changed, pins); }
+};
+
+template <class... Handlers>
+struct PcintTable;
+
+template <>
+struct PcintTable<> {
+    static constexpr uint8_t mask = 0;
+    static void dispatch(uint8_t, uint8_t) {}
+};
+
+template <class H, class... Rest>
+struct PcintTable<H, Rest...> {
+    static constexpr uint8_t mask = H::mask | PcintTable<Rest...>::mask;
+    static void dispatch(uint8_t changed, uint8_t pins) {
+        if (changed & H::mask) H::call(changed & H::mask, pins);
+        PcintTable<Rest...>::dispatch(changed, pins);
+    }
+};
+
+#ifdef PCINT_PROFILE
+typedef Pin<PortB, 5> PcintProfilePin;
+#endif
+
+template <class Port, class Table>
+struct PcintPort {
+    static uint8_t last;    // port state at the previous interrupt
+
+    static void isr() {
+#ifdef PCINT_PROFILE
+        PcintProfilePin::high();
+#endif
+        uint8_t pins = io_reg(Port::pin);
+        uint8_t changed = (pins ^ last) & Table::mask;
+        last = pins;
+        Table::dispatch(changed, pins);
+#ifdef PCINT_PROFILE
+        PcintProfilePin::low();
+#endif
+    }
+
+    // Take a fresh snapshot, e.g. before enabling the interrupt
+    static void sync() {
+        last = io_reg(Port::pin);
+    }
+};
+
+template <class Port, class Table>
+uint8_t PcintPort<Port, Table>::last;
+
+// Define the vector of one port with its handler table
+#define PCINT_VECTOR(vect, Port, Table) \
+    ISR(vect) { PcintPort<Port, Table>::isr(); }
+
+// Snapshots (and profile pin) setup; the application defines it next to
+// its tables and calls it once before sei()
+void pcint_init();
+
+#endif
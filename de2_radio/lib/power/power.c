@@ -0,0 +1,117 @@
+/*
+ * MCU power down with pin change wakeup and a watchdog second counter,
+ * idle sleep with the CPU load counter.
+ */
+
+// -- Includes -------------------------------------------------------
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+#include <power.h>
+#include <systick.h>
+
+
+// -- Local variables ------------------------------------------------
+static volatile uint16_t seconds;   // watchdog wakeups while asleep
+static volatile uint8_t pinWake;    // a masked pin changed
+static uint32_t idleUs;             // time in power_idle()
+static uint32_t loadFrom;           // millis() of the last power_load()
+
+
+// -- Function definitions -------------------------------------------
+uint16_t power_down(uint8_t maskB, uint8_t maskD)
+{
+    uint8_t pcicr = PCICR, pcmsk0 = PCMSK0, pcmsk2 = PCMSK2;
+
+    seconds = 0;
+    pinWake = 0;
+
+    // Wake sources: pin change on the masked pins, stale flags cleared
+    PCMSK0 |= maskB;
+    PCMSK2 |= maskD;
+    PCIFR = (1 << PCIF0) | (1 << PCIF2);
+    PCICR |= (maskB ? (1 << PCIE0) : 0) | (maskD ? (1 << PCIE2) : 0);
+
+    // Watchdog in interrupt mode, 1 s
+    cli();
+    wdt_reset();
+    WDTCSR = (1 << WDCE) | (1 << WDE);
+    WDTCSR = (1 << WDIE) | (1 << WDP2) | (1 << WDP1);
+    sei();
+
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    while (!pinWake) {
+        cli();
+        if (pinWake) {
+            sei();
+            break;
+        }
+        sleep_enable();
+        sleep_bod_disable();
+        sei();
+        sleep_cpu();    // the instruction after sei runs before any interrupt
+        sleep_disable();
+    }
+
+    // Watchdog off
+    cli();
+    wdt_reset();
+    MCUSR &= ~(1 << WDRF);
+    WDTCSR = (1 << WDCE) | (1 << WDE);
+    WDTCSR = 0;
+    sei();
+
+    PCMSK0 = pcmsk0;
+    PCMSK2 = pcmsk2;
+    PCICR = pcicr;
+
+    return seconds;
+}
+
+
+ISR(WDT_vect)
+{
+    seconds++;
+}
+
+
+/*
+ * Pin change wakeup, registered with the PCINT dispatcher for the front
+ * panel pins of PORTB and PORTD.
+ */
+void power_pin_change(uint8_t changed, uint8_t pins)
+{
+    (void)changed;
+    (void)pins;
+    pinWake = 1;
+}
+
+
+void power_idle(void)
+{
+    uint32_t start = micros();
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+    sei();
+    sleep_cpu();        // the instruction after sei runs before any interrupt
+    sleep_disable();    // the waking ISR has run by now
+
+    idleUs += micros() - start;
+}
+
+
+uint8_t power_load(uint32_t *awakeMs, uint32_t *asleepMs)
+{
+    uint32_t now = millis();
+    uint32_t total = now - loadFrom;
+    uint32_t asleep = idleUs / 1000;
+
+    if (asleep > total) asleep = total;
+    loadFrom = now;
+    idleUs = 0;
+
+    if (awakeMs) *awakeMs = total - asleep;
+    if (asleepMs) *asleepMs = asleep;
+    return total ? (uint8_t)((total - asleep) * 100 / total) : 0;
+}
@@ -0,0 +1,76 @@
+#ifndef POWER_H
+# define POWER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @defgroup power MCU power down <power.h>
+ * @code #include <power.h> @endcode
+ *
+ * @brief Power-down sleep with pin change wakeup, idle sleep and CPU load.
+ *
+ * The AVR sleeps in SLEEP_MODE_PWR_DOWN until one of the given PORTB or
+ * PORTD pins changes. power_pin_change() has to be in the PCINT handler
+ * tables of both ports. The watchdog interrupt wakes it once a second for a
+ * few microseconds to count the time asleep, since all timers are stopped.
+ *
+ * Between tasks the main loop sleeps in SLEEP_MODE_IDLE with power_idle().
+ * The clocks keep running, so any enabled interrupt wakes the CPU: the
+ * 1 ms system tick at the latest, or UART, SPI, EEPROM and pin changes.
+ * The time spent there is summed up for power_load().
+ * @{
+ */
+
+// -- Includes -------------------------------------------------------
+#include <stdint.h>
+
+
+// -- Function prototypes --------------------------------------------
+/**
+ * @brief  Sleep until a pin change on one of the masked pins.
+ *         Peripherals that must not run (UART, EEPROM writes, tuner)
+ *         have to be idle or stopped by the caller.
+ * @param  maskB PORTB pins that wake the MCU (PCINT0..7)
+ * @param  maskD PORTD pins that wake the MCU (PCINT16..23)
+ * @return Time asleep in seconds (1 s resolution)
+ */
+uint16_t power_down(uint8_t maskB, uint8_t maskD);
+
+
+/**
+ * @brief  Pin change handler for the PCINT dispatcher, ends power_down().
+ * @param  changed Changed pins
+ * @param  pins Port snapshot
+ * @return none
+ */
+void power_pin_change(uint8_t changed, uint8_t pins);
+
+
+/**
+ * @brief  Idle sleep until the next interrupt. Call with interrupts
+ *         disabled, right after checking that nothing is due, so an
+ *         interrupt in between cannot be slept through. Returns with
+ *         interrupts enabled.
+ * @return none
+ */
+void power_idle(void);
+
+
+/**
+ * @brief  CPU time awake and in idle sleep since the last call.
+ * @param  awakeMs Filled with the time awake in ms
+ * @param  asleepMs Filled with the time in power_idle() in ms
+ * @return Load in percent
+ */
+uint8_t power_load(uint32_t *awakeMs, uint32_t *asleepMs);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
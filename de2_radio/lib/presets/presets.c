@@ -0,0 +1,203 @@
+/*
+ * Station presets: EEPROM list of channel bytes with a factory set in flash.
+ */
+
+// -- Includes -------------------------------------------------------
+#include <avr/eeprom.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include <presets.h>
+
+
+// -- Factory set ----------------------------------------------------
+static const uint8_t presets_factory[] PROGMEM = {
+    PRESET_CH( 8760),  // Rádio Impuls, Vysílač Kojál
+    PRESET_CH( 8820),  // Radio Kiss (JihM), Vysílač Hády
+    PRESET_CH( 8890),  // Rádio Jih, Hodonín, Babí lom
+    PRESET_CH( 8950),  // ČRo Radiožurnál, Husovice, ul. Míčkova 929/2
+    PRESET_CH( 8990),  // Radio Wien, Rakousko, Vídeň 1 - Kahlenberg
+    PRESET_CH( 9040),  // ČRo Vltava, Vysílač Hády
+    PRESET_CH( 9100),  // Rádio Beat, Kohoutovice, Hotel Myslivna
+    PRESET_CH( 9200),  // Radio Österreich 1, Rakousko, Vídeň 1 - Kahlenberg
+    PRESET_CH( 9260),  // ČRo Plus, Vysílač Hády
+    PRESET_CH( 9310),  // ČRo Brno, Vysílač Hády
+    PRESET_CH( 9360),  // ČRo Brno, Hodonín, Babí lom
+    PRESET_CH( 9460),  // Evropa 2, Blansko, Olešná
+    PRESET_CH( 9510),  // ČRo Radiožurnál, Vysílač Kojál
+    PRESET_CH( 9550),  // Radio Čas, Barvičova, Gymnázium
+    PRESET_CH( 9640),  // Fajn rádio, Husovice, ul. Provazníkova 47
+    PRESET_CH( 9680),  // Country Radio, Kohoutovice, ul. Voříškova 2
+    PRESET_CH( 9760),  // Radio Hey, Katedrála sv. Petra a Pavla
+    PRESET_CH( 9790),  // Radio Niederösterreich, Rakousko, Vídeň 1 - Kahlenberg
+    PRESET_CH( 9810),  // Signál rádio, Kohoutovice, Hotel Myslivna
+    PRESET_CH( 9900),  // Hitrádio City, Vysoké učení technické v Brně
+    PRESET_CH( 9940),  // Color Music Rádio, Katedrála sv. Petra a Pavla
+    PRESET_CH( 9990),  // Hitradio Ö3, Rakousko, Vídeň 1 - Kahlenberg
+    PRESET_CH(10020),  // ČRo Dvojka, Husovice, ul. Míčkova 929/2
+    PRESET_CH(10040),  // ČRo Vltava, Hodonín, Babí lom
+    PRESET_CH(10080),  // Hitrádio City, Barvičova, Gymnázium
+    PRESET_CH(10130),  // Rádio Prostor / BBC World Service, Vysílač Hády
+    PRESET_CH(10200),  // ČRo Dvojka, Vysílač Kojál
+    PRESET_CH(10250),  // oe24 Radio, Rakousko, Vídeň 1 - Kahlenberg
+    PRESET_CH(10300),  // Radio Krokodýl, Vysílač Hády
+    PRESET_CH(10340),  // Rádio Blaník (Morava a Slez.), Vysílač Hády
+    PRESET_CH(10380),  // radio FM4, Rakousko, Vídeň 1 - Kahlenberg
+    PRESET_CH(10410),  // Radio Kiss (JihM), Blansko, Zborovce
+    PRESET_CH(10450),  // Frekvence 1, Vysílač Kojál
+    PRESET_CH(10510),  // Rádio Jih, Kohoutovice, Hotel Myslivna
+    PRESET_CH(10550),  // Evropa 2, Vysílač Hády
+    PRESET_CH(10580),  // kronehit, Rakousko, Vídeň 1 - Kahlenberg
+    PRESET_CH(10620),  // ČRo Radiožurnál, Hodonín, Babí lom
+    PRESET_CH(10650),  // ČRo Brno, Vysílač Kojál
+    PRESET_CH(10700),  // Free Rádio, Kohoutovice, Hotel Myslivna
+    PRESET_CH(10750)   // Radio Proglas, Vysílač Hády
+};
+
+#if (PRESETS_EE_ADDR + PRESETS_EE_SIZE) > (E2END + 1)
+# error "preset list does not fit into EEPROM"
+#endif
+
+#define EE_MAGIC    ((uint8_t *)(uintptr_t)(PRESETS_EE_ADDR))
+#define EE_COUNT    ((uint8_t *)(uintptr_t)(PRESETS_EE_ADDR + 1))
+#define EE_CH(i)    ((uint8_t *)(uintptr_t)(PRESETS_EE_ADDR + 2 + (i)))
+
+
+// -- Local variables ------------------------------------------------
+static uint8_t count;
+
+
+// -- Local functions ------------------------------------------------
+/*
+ * The state journal writes EEPROM from the EEPROM ready interrupt. Start
+ * an access only with interrupts off and no write running, so the ISR
+ * cannot move EEAR in between.
+ */
+static uint8_t ee_read(const uint8_t *addr)
+{
+    for (;;) {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            if (eeprom_is_ready()) return eeprom_read_byte(addr);
+        }
+    }
+}
+
+
+static void ee_update(uint8_t *addr, uint8_t value)
+{
+    for (;;) {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            if (eeprom_is_ready()) {
+                eeprom_update_byte(addr, value);
+                return;
+            }
+        }
+    }
+}
+
+
+// -- Function definitions -------------------------------------------
+void presets_init(void)
+{
+    count = ee_read(EE_COUNT);
+    if (ee_read(EE_MAGIC) != PRESETS_MAGIC || count > PRESETS_MAX)
+        presets_factory_reset();
+}
+
+
+void presets_factory_reset(void)
+{
+    count = sizeof(presets_factory);
+    for (uint8_t i = 0; i < count; i++)
+        ee_update(EE_CH(i), pgm_read_byte(&presets_factory[i]));
+    ee_update(EE_COUNT, count);
+    ee_update(EE_MAGIC, PRESETS_MAGIC);
+}
+
+
+int presets_factory_get(uint8_t index)
+{
+    if (index >= sizeof(presets_factory)) return 0;
+    return PRESET_BAND_START + pgm_read_byte(&presets_factory[index]) * PRESET_SPACING;
+}
+
+
+uint8_t presets_factory_count(void)
+{
+    return sizeof(presets_factory);
+}
+
+
+uint8_t presets_count(void)
+{
+    return count;
+}
+
+
+int presets_get(uint8_t index)
+{
+    if (index >= count) return 0;
+    return PRESET_BAND_START + ee_read(EE_CH(index)) * PRESET_SPACING;
+}
+
+
+uint8_t presets_find(int freq)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        if (presets_get(i) == freq) return i;
+    }
+    return PRESET_NONE;
+}
+
+
+uint8_t presets_save(int freq)
+{
+    uint8_t i = presets_find(freq);
+    if (i != PRESET_NONE) return i;
+    if (count >= PRESETS_MAX) return PRESET_NONE;
+    if (freq < PRESET_BAND_START || PRESET_CH(freq) > 0xfe) return PRESET_NONE;
+
+    ee_update(EE_CH(count), PRESET_CH(freq));
+    count++;
+    ee_update(EE_COUNT, count);
+    return count - 1;
+}
+
+
+uint8_t presets_delete(uint8_t index)
+{
+    if (index >= count) return 1;
+    for (uint8_t i = index; i + 1 < count; i++)
+        ee_update(EE_CH(i), ee_read(EE_CH(i + 1)));
+    count--;
+    ee_update(EE_COUNT, count);
+    return 0;
+}
+
+
+uint8_t presets_move(uint8_t from, uint8_t to)
+{
+    if (from >= count || to >= count) return 1;
+    uint8_t ch = ee_read(EE_CH(from));
+    // shift the entries in between by one towards 'from'
+    while (from < to) {
+        ee_update(EE_CH(from), ee_read(EE_CH(from + 1)));
+        from++;
+    }
+    while (from > to) {
+        ee_update(EE_CH(from), ee_read(EE_CH(from - 1)));
+        from--;
+    }
+    ee_update(EE_CH(to), ch);
+    return 0;
+}
+
+
+uint8_t presets_replace(const uint8_t *channels, uint8_t n)
+{
+    if (n > PRESETS_MAX) n = PRESETS_MAX;
+    for (uint8_t i = 0; i < n; i++)
+        ee_update(EE_CH(i), channels[i]);
+    count = n;
+    ee_update(EE_COUNT, count);     // last, an interrupted write leaves valid channels
+    return count;
+}
@@ -0,0 +1,134 @@
+#ifndef PRESETS_H
+# define PRESETS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @defgroup presets Station presets <presets.h>
+ * @code #include <presets.h> @endcode
+ *
+ * @brief Station presets kept in EEPROM, factory set in flash.
+ *
+ * Every preset is one byte: the channel index above PRESET_BAND_START in
+ * PRESET_SPACING steps (0..205 for 87.5-108 MHz at 100 kHz). The list
+ * lives only in EEPROM, nothing of it is held in SRAM except its length.
+ * A blank or foreign EEPROM is filled with the factory set on init.
+ *
+ * EEPROM layout from PRESETS_EE_ADDR:
+ *   magic, count, PRESETS_MAX channel bytes
+ * @{
+ */
+
+// -- Includes -------------------------------------------------------
+#include <stdint.h>
+
+
+// -- Defines --------------------------------------------------------
+#define PRESET_BAND_START 8750  /**< @brief Frequency of channel 0 (10 kHz units) */
+#define PRESET_SPACING      10  /**< @brief Channel spacing (10 kHz units) */
+#define PRESETS_MAX         64  /**< @brief Capacity of the EEPROM list */
+#define PRESETS_EE_ADDR  0x000  /**< @brief First EEPROM byte of the list */
+#define PRESETS_EE_SIZE  (2 + PRESETS_MAX) /**< @brief EEPROM bytes used */
+#define PRESETS_MAGIC     0xA5  /**< @brief Layout version marker */
+#define PRESET_NONE       0xff  /**< @brief Invalid index / not found */
+
+/** @brief Channel byte of a frequency, for the factory table */
+#define PRESET_CH(freq) (((freq) - PRESET_BAND_START) / PRESET_SPACING)
+
+
+// -- Function prototypes --------------------------------------------
+/**
+ * @brief  Load the preset count, restore the factory set if the EEPROM
+ *         does not hold a valid list.
+ * @return none
+ */
+void presets_init(void);
+
+
+/**
+ * @brief  Replace the list with the factory set from flash.
+ * @return none
+ */
+void presets_factory_reset(void);
+
+
+/**
+ * @brief  Frequency of one preset of the factory set, which stays in
+ *         flash whatever the EEPROM holds.
+ * @param  index Position 0..presets_factory_count()-1
+ * @return Frequency in 10 kHz units, 0 if index is out of range
+ */
+int presets_factory_get(uint8_t index);
+
+
+/** @brief Number of presets in the factory set */
+uint8_t presets_factory_count(void);
+
+
+/**
+ * @brief  Number of stored presets.
+ * @return Count (0..PRESETS_MAX)
+ */
+uint8_t presets_count(void);
+
+
+/**
+ * @brief  Frequency of one preset.
+ * @param  index Preset position 0..presets_count()-1
+ * @return Frequency in 10 kHz units, 0 if index is out of range
+ */
+int presets_get(uint8_t index);
+
+
+/**
+ * @brief  Position of a frequency in the list.
+ * @param  freq Frequency in 10 kHz units
+ * @return Index or PRESET_NONE
+ */
+uint8_t presets_find(int freq);
+
+
+/**
+ * @brief  Append a frequency to the list (no duplicates).
+ * @param  freq Frequency in 10 kHz units
+ * @return Index of the preset, PRESET_NONE if full or out of band
+ */
+uint8_t presets_save(int freq);
+
+
+/**
+ * @brief  Remove one preset, the following ones move up.
+ * @param  index Preset position
+ * @return 0 on success, 1 if index is out of range
+ */
+uint8_t presets_delete(uint8_t index);
+
+
+/**
+ * @brief  Move one preset to another position.
+ * @param  from Current position
+ * @param  to New position
+ * @return 0 on success, 1 if an index is out of range
+ */
+uint8_t presets_move(uint8_t from, uint8_t to);
+
+
+/**
+ * @brief  Replace the whole list, e.g. with the stations of a band scan.
+ *         Blocks for the EEPROM writes, 3.4 ms per changed byte.
+ * @param  channels Channel bytes (see PRESET_CH())
+ * @param  n Number of channels, at most PRESETS_MAX are kept
+ * @return Number of presets stored
+ */
+uint8_t presets_replace(const uint8_t *channels, uint8_t n);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
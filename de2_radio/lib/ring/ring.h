@@ -0,0 +1,113 @@
+#ifndef RING_H
+#define RING_H
+
+/*
+ * Single-producer/single-consumer ring buffer for C++ code.
+ *
+ *   static Ring<uint8_t, 64> rx;
+ *   ISR(...) { if (!rx.push(UDR0)) overflow = 1; }    // producer
+ *   uint8_t c; if (rx.pop(c)) ...                      // consumer
+ *
+ * One side may run in an ISR and the other in the main loop without
+ * disabling interrupts: the producer only writes head, the consumer only
+ * writes tail, and both indices are single bytes, which the AVR loads and
+ * stores atomically. The element is copied before the index that hands it
+ * over is stored.
+ *
+ * The indices run freely and are masked on access, so all N slots are
+ * usable. N is a power of two up to 128. There is no constructor; a ring
+ * in static storage starts out empty, any other one needs clear() first.
+ */
+
+#include <stdint.h>
+
+template <typename T, uint8_t N>
+class Ring {
+    static_assert(N >= 2 && N <= 128 && (N & (N - 1)) == 0,
+                  "ring size must be a power of two from 2 to 128");
+
+public:
+    static constexpr uint8_t capacity = N;
+
+    // -- either side, the result may be stale by the time it is used --
+    uint8_t count() const { return (uint8_t)(head - tail); }
+    uint8_t space() const { return N - count(); }
+    bool empty() const    { return head == tail; }
+    bool full() const     { return count() == N; }
+
+    // -- producer --
+    bool push(const T& item) {
+        uint8_t h = head;
+        if ((uint8_t)(h - tail) == N) return false;
+        buf[h & MASK] = item;
+        barrier();
+        head = h + 1;
+        return true;
+    }
+
+    // Copies as many items as fit, returns how many
+    uint8_t push(const T *items, uint8_t n) {
+        uint8_t h = head;
+        uint8_t free = N - (uint8_t)(h - tail);
+        if (n > free) n = free;
+        for (uint8_t i = 0; i < n; i++) buf[(uint8_t)(h + i) & MASK] = items[i];
+        barrier();
+        head = h + n;
+        return n;
+    }
+
+    // -- consumer --
+    bool pop(T& item) {
+        uint8_t t = tail;
+        if (head == t) return false;
+        barrier();
+        item = buf[t & MASK];
+        barrier();
+        tail = t + 1;
+        return true;
+    }
+
+    // Copies up to n items, returns how many
+    uint8_t pop(T *items, uint8_t n) {
+        uint8_t t = tail;
+        uint8_t used = (uint8_t)(head - t);
+        if (n > used) n = used;
+        barrier();
+        for (uint8_t i = 0; i < n; i++) items[i] = buf[(uint8_t)(t + i) & MASK];
+        barrier();
+        tail = t + n;
+        return n;
+    }
+
+    bool peek(T& item) const {
+        uint8_t t = tail;
+        if (head == t) return false;
+        barrier();
+        item = buf[t & MASK];
+        return true;
+    }
+
+    // Drops up to n of the oldest items, returns how many
+    uint8_t discard(uint8_t n) {
+        uint8_t t = tail;
+        uint8_t used = (uint8_t)(head - t);
+        if (n > used) n = used;
+        tail = t + n;
+        return n;
+    }
+
+    // Drops everything pushed so far
+    void clear() { tail = head; }
+
+private:
+    static constexpr uint8_t MASK = N - 1;
+
+    // keeps the compiler from moving element accesses across index accesses
+    static void barrier() { __asm__ __volatile__ ("" ::: "memory"); }
+
+    T buf[N];
+    volatile uint8_t head;          // written by the producer only
+    volatile uint8_t tail;          // written by the consumer only
+};
+
+#endif
@@ -0,0 +1,227 @@
+/*
+ * Cooperative scheduler: statically allocated tasks on a hierarchical
+ * timer wheel, timed by millis().
+ *
+ * The wheel has four levels of 16 slots, one per hex digit of the 16-bit
+ * due time. A task sits on the level of the highest digit in which its due
+ * time differs from the wheel time, in the slot of that digit. Whenever a
+ * digit of the wheel time rolls over, the slot of the next level that has
+ * become current is cascaded one level down, so a task moves at most three
+ * times before it expires from level 0.
+ */
+
+// -- Includes -------------------------------------------------------
+#include <stddef.h>
+#include <scheduler.h>
+#include <systick.h>
+
+
+// -- Defines --------------------------------------------------------
+#define WHEEL_BITS      4
+#define WHEEL_SLOTS     (1 << WHEEL_BITS)
+#define WHEEL_MASK      (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS    4           // 16 bits of due time
+
+
+// -- Local variables ------------------------------------------------
+static sched_task_t *wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+static sched_task_t *ready;         // expired, run by the next sched_run()
+static sched_task_t *running;       // expired, being run by sched_run()
+static uint16_t wheelNow;           // next tick to expire
+static uint8_t armed;               // tasks on the wheel or in a list
+static uint32_t worstUs;
+static sched_fn_t worstFn;
+static uint32_t worstTickUs;
+
+
+// -- Local functions ------------------------------------------------
+static void list_add(sched_task_t **head, sched_task_t *task)
+{
+    task->next = *head;
+    if (task->next) task->next->pprev = &task->next;
+    task->pprev = head;
+    *head = task;
+}
+
+
+static void list_del(sched_task_t *task)
+{
+    *task->pprev = task->next;
+    if (task->next) task->next->pprev = task->pprev;
+}
+
+
+// File the task by its due time; past due goes straight to the ready list
+static void wheel_add(sched_task_t *task)
+{
+    uint16_t due = task->due;
+    uint16_t diff = due ^ wheelNow;
+    uint8_t level = 0;
+
+    if ((int16_t)(due - wheelNow) < 0) {
+        list_add(&ready, task);
+        return;
+    }
+    while (diff > WHEEL_MASK) {
+        diff >>= WHEEL_BITS;
+        due >>= WHEEL_BITS;
+        level++;
+    }
+    list_add(&wheel[level][due & WHEEL_MASK], task);
+}
+
+
+// Move every task of a slot to where it belongs at the current wheel time
+static void wheel_cascade(uint8_t level)
+{
+    sched_task_t **slot = &wheel[level][(wheelNow >> (level * WHEEL_BITS)) & WHEEL_MASK];
+    sched_task_t *task = *slot;
+
+    *slot = NULL;
+    while (task) {
+        sched_task_t *next = task->next;
+        wheel_add(task);
+        task = next;
+    }
+}
+
+
+// Expire the tasks due at wheelNow and step the wheel by one tick
+static void wheel_tick(void)
+{
+    // cascade from the top, so a task may drop more than one level
+    if ((wheelNow & 0x0fff) == 0) wheel_cascade(3);
+    if ((wheelNow & 0x00ff) == 0) wheel_cascade(2);
+    if ((wheelNow & 0x000f) == 0) wheel_cascade(1);
+
+    sched_task_t **slot = &wheel[0][wheelNow & WHEEL_MASK];
+    while (*slot) {
+        sched_task_t *task = *slot;
+        list_del(task);
+        list_add(&ready, task);
+    }
+    wheelNow++;
+}
+
+
+static void sched_start(sched_task_t *task, sched_fn_t fn, uint16_t period, uint16_t delay)
+{
+    if (task->active) list_del(task);
+    else if (!armed++) wheelNow = millis();     // empty wheel, no catching up
+
+    task->fn = fn;
+    task->period = period;
+    task->due = (uint16_t)millis() + delay;
+    task->active = 1;
+    wheel_add(task);
+}
+
+
+// -- Function definitions -------------------------------------------
+void sched_every(sched_task_t *task, sched_fn_t fn, uint16_t period)
+{
+    sched_start(task, fn, period, 0);
+}
+
+
+void sched_after(sched_task_t *task, sched_fn_t fn, uint16_t delay)
+{
+    sched_start(task, fn, 0, delay);
+}
+
+
+void sched_cancel(sched_task_t *task)
+{
+    if (!task->active) return;
+    list_del(task);
+    task->active = 0;
+    armed--;
+}
+
+
+uint8_t sched_active(const sched_task_t *task)
+{
+    return task->active;
+}
+
+
+uint8_t sched_run(void)
+{
+    uint16_t now = (uint16_t)millis();
+    uint8_t ran = 0;
+
+    // catch up with the clock, after a long task several ticks at once
+    while ((int16_t)(now - wheelNow) >= 0) {
+        uint32_t start = micros();
+        wheel_tick();
+        uint32_t took = micros() - start;
+        if (took > worstTickUs) worstTickUs = took;
+    }
+
+    // run what has expired until now; tasks started from here with no
+    // delay wait for the next sched_run()
+    running = ready;
+    if (running) running->pprev = &running;
+    ready = NULL;
+
+    sched_task_t *t;
+    while ((t = running) != NULL) {
+        list_del(t);
+        if (t->period) {
+            // keep the phase; after a long stall skip the missed runs
+            t->due += t->period;
+            if ((int16_t)(now - t->due) >= 0) t->due = now + t->period;
+            wheel_add(t);
+        }
+        else {
+            t->active = 0;      // one-shot, may restart itself
+            armed--;
+        }
+
+        uint32_t start = micros();
+        t->fn();
+        uint32_t took = micros() - start;
+        if (took > worstUs) {
+            worstUs = took;
+            worstFn = t->fn;
+        }
+        ran++;
+    }
+    return ran;
+}
+
+
+uint16_t sched_idle_ms(void)
+{
+    uint16_t now = (uint16_t)millis();
+
+    if (ready) return 0;
+    if ((int16_t)(now - wheelNow) >= 0) return 0;   // ticks to catch up
+    if (!armed) return 0xffff;
+
+    // up to the next level 0 slot in use or the next cascade
+    uint16_t tick = wheelNow;
+    while ((tick & WHEEL_MASK) && !wheel[0][tick & WHEEL_MASK]) tick++;
+    return tick - now;
+}
+
+
+uint32_t sched_worst_us(sched_fn_t *fn)
+{
+    if (fn) *fn = worstFn;
+    return worstUs;
+}
+
+
+uint32_t sched_tick_us(void)
+{
+    return worstTickUs;
+}
+
+
+void sched_reset_stats(void)
+{
+    worstUs = 0;
+    worstFn = NULL;
+    worstTickUs = 0;
+}
@@ -0,0 +1,127 @@
+#ifndef SCHEDULER_H
+# define SCHEDULER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @defgroup sched Cooperative scheduler <scheduler.h>
+ * @code #include <scheduler.h> @endcode
+ *
+ * @brief Periodic and one-shot tasks run from the main loop.
+ *
+ * Tasks are statically allocated sched_task_t objects owned by their
+ * modules. sched_run() runs every task that is due, each to completion; a
+ * task that has to wait schedules a continuation instead of blocking.
+ * Any number of tasks can serve as timeouts: they wait on a hierarchical
+ * timer wheel, so starting and cancelling one is O(1) and each tick costs
+ * the same however many are running. Neither may be called from an ISR.
+ *
+ * The scheduler measures every task run with micros(); the longest one
+ * bounds how late any other task (or the front panel) can be served.
+ * @{
+ */
+
+// -- Includes -------------------------------------------------------
+#include <stdint.h>
+
+
+// -- Types ----------------------------------------------------------
+typedef void (*sched_fn_t)(void);
+
+/** @brief Task object, treat as opaque */
+typedef struct sched_task {
+    sched_fn_t fn;
+    uint16_t period;            /**< @brief 0 = one-shot */
+    uint16_t due;               /**< @brief millis() of the next run */
+    uint8_t active;
+    struct sched_task *next;
+    struct sched_task **pprev;
+} sched_task_t;
+
+
+// -- Function prototypes --------------------------------------------
+/**
+ * @brief  Run fn every period ms, the first time on the next sched_run().
+ *         Restarts the task if it is already active.
+ * @param  task Task object (static)
+ * @param  fn Function to run
+ * @param  period Interval in ms, 1-32767
+ * @return none
+ */
+void sched_every(sched_task_t *task, sched_fn_t fn, uint16_t period);
+
+
+/**
+ * @brief  Run fn once, delay ms from now. Restarts the task if it is
+ *         already active.
+ * @param  task Task object (static)
+ * @param  fn Function to run
+ * @param  delay Delay in ms, 0-32767
+ * @return none
+ */
+void sched_after(sched_task_t *task, sched_fn_t fn, uint16_t delay);
+
+
+/**
+ * @brief  Stop a task.
+ * @param  task Task object
+ * @return none
+ */
+void sched_cancel(sched_task_t *task);
+
+
+/**
+ * @brief  Task is waiting for its next run.
+ * @param  task Task object
+ * @return 1 if active
+ */
+uint8_t sched_active(const sched_task_t *task);
+
+
+/**
+ * @brief  Run all due tasks once. Call from the main loop.
+ * @return Number of tasks that ran
+ */
+uint8_t sched_run(void);
+
+
+/**
+ * @brief  Time for which no task is due, at most up to the next cascade
+ *         of the timer wheel (16 ms).
+ * @return ms, 0 if a task is due now, 0xffff if none is active
+ */
+uint16_t sched_idle_ms(void);
+
+
+/**
+ * @brief  Longest single task run since the last sched_reset_stats().
+ * @param  fn Filled with the function of that run, may be NULL
+ * @return Duration in us
+ */
+uint32_t sched_worst_us(sched_fn_t *fn);
+
+
+/**
+ * @brief  Longest timer wheel step (expiry of one tick) since the last
+ *         sched_reset_stats().
+ * @return Duration in us
+ */
+uint32_t sched_tick_us(void);
+
+
+/**
+ * @brief  Clear the worst case statistics.
+ * @return none
+ */
+void sched_reset_stats(void);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ * Serial command shell: incremental line reader and command dispatch.
+ */
+
+// -- Includes -------------------------------------------------------
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <string.h>
+#include <shell.h>
+#include <uart.h>
+
+
+// -- Local variables ------------------------------------------------
+static const shell_cmd_t *commands;     // PROGMEM
+static uint8_t commandCount;
+static char line[SHELL_LINE_MAX];
+static uint8_t length;
+static uint8_t overflow;                // line too long, drop until its end
+
+
+// -- Local functions ------------------------------------------------
+static void shell_execute(void)
+{
+    char *argv[SHELL_ARGS_MAX];
+    uint8_t argc = 0;
+    char *p = line;
+
+    // split at spaces, extra words stay attached to the last one
+    while (*p && argc < SHELL_ARGS_MAX) {
+        while (*p == ' ') *p++ = '\0';
+        if (!*p) break;
+        argv[argc++] = p;
+        if (argc == SHELL_ARGS_MAX) break;
+        while (*p && *p != ' ') p++;
+    }
+    if (!argc) return;
+
+    for (uint8_t i = 0; i < commandCount; i++) {
+        if (strcmp_P(argv[0], commands[i].name) == 0) {
+            shell_fn_t fn = (shell_fn_t)pgm_read_ptr(&commands[i].fn);
+            fn(argc, argv);
+            return;
+        }
+    }
+    uart_puts_P("err unknown command\n");
+}
+
+
+// -- Function definitions -------------------------------------------
+void shell_init(const shell_cmd_t *table, uint8_t count)
+{
+    commands = table;
+    commandCount = count;
+    length = 0;
+    overflow = 0;
+}
+
+
+uint8_t shell_poll(void)
+{
+    for (uint8_t n = 0; n < SHELL_BYTES_PER_POLL; n++) {
+        unsigned int c = uart_getc();
+        if (c & UART_NO_DATA) break;
+        c &= 0xff;      // a receive error only garbles this line
+
+        if (c == '\r' || c == '\n') {
+            uint8_t ran = length != 0 || overflow;
+            line[length] = '\0';
+            if (overflow) uart_puts_P("err line too long\n");
+            else if (length) shell_execute();
+            length = 0;
+            overflow = 0;
+            if (ran) return 1;      // one command per call
+        }
+        else if (c == '\b' || c == 0x7f) {
+            if (length) length--;
+        }
+        else if (length < SHELL_LINE_MAX - 1) {
+            line[length++] = c;
+        }
+        else {
+            overflow = 1;
+        }
+    }
+    return 0;
+}
+
+
+void shell_help(void)
+{
+    for (uint8_t i = 0; i < commandCount; i++) {
+        uart_puts_p(commands[i].name);
+        uart_putc(i + 1 < commandCount ? ' ' : '\n');
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef SHELL_H
+# define SHELL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @defgroup shell Serial command shell <shell.h>
+ * @code #include <shell.h> @endcode
+ *
+ * @brief Line oriented commands read from the UART receive buffer.
+ *
+ * shell_poll() takes at most SHELL_BYTES_PER_POLL bytes from the UART and
+ * runs at most one command per call, so a host that sends faster than the
+ * main loop reads only fills the receive buffer. A line is split into
+ * words at spaces and looked up in a command table in program memory.
+ * Handlers must return quickly; longer work is started and finished by a
+ * task.
+ *
+ * Every command answers with at least one line. Errors start with "err".
+ * Lines end with CR, LF or both, backspace deletes. Nothing is echoed.
+ * @{
+ */
+
+// -- Includes -------------------------------------------------------
+#include <stdint.h>
+
+
+// -- Defines --------------------------------------------------------
+#define SHELL_LINE_MAX        40    /**< @brief Longest line incl. terminator */
+#define SHELL_ARGS_MAX         4    /**< @brief Words per line incl. the command */
+#define SHELL_BYTES_PER_POLL  16    /**< @brief Bytes read per shell_poll() */
+
+
+// -- Types ----------------------------------------------------------
+/** @brief Command handler, argv[0] is the command name */
+typedef void (*shell_fn_t)(uint8_t argc, char *argv[]);
+
+/** @brief Command table entry, the table lives in PROGMEM */
+typedef struct {
+    char name[8];
+    shell_fn_t fn;
+} shell_cmd_t;
+
+
+// -- Function prototypes --------------------------------------------
+/**
+ * @brief  Set the command table and clear the line buffer.
+ * @param  table Commands in program memory
+ * @param  count Number of commands
+ * @return none
+ */
+void shell_init(const shell_cmd_t *table, uint8_t count);
+
+
+/**
+ * @brief  Read the pending input, run a complete command. Call
+ *         periodically from the main loop.
+ * @return 1 if a command line was handled
+ */
+uint8_t shell_poll(void);
+
+
+/**
+ * @brief  Print the names of all commands, for a "help" handler.
+ * @return none
+ */
+void shell_help(void);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
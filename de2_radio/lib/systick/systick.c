@@ -0,0 +1,59 @@
+/*
+ * System tick: Timer2 compare match every 1 ms.
+ */
+
+// -- Includes -------------------------------------------------------
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <systick.h>
+#include <input.h>
+#include "timer.h"
+
+
+// -- Local variables ------------------------------------------------
+static volatile uint32_t ticks;
+
+
+// -- Function definitions -------------------------------------------
+void systick_init(void)
+{
+    tim2_ctc_mode();
+    OCR2A = SYSTICK_TOP;
+    TCNT2 = 0;
+    tim2_ovf_1ms();             // prescaler 64: 4 us per count
+    tim2_compa_enable();
+}
+
+
+uint32_t millis(void)
+{
+    uint32_t ms;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ms = ticks;
+    }
+    return ms;
+}
+
+
+uint32_t micros(void)
+{
+    uint32_t ms;
+    uint8_t count, pending;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ms = ticks;
+        count = TCNT2;
+        pending = TIFR2 & (1 << OCF2A);
+    }
+    // the counter restarted but the tick ISR has not run yet
+    if (pending && count < SYSTICK_TOP / 2) ms++;
+
+    return ms * 1000 + count * SYSTICK_US;
+}
+
+
+ISR(TIMER2_COMPA_vect)
+{
+    ticks++;
+    input_tick();
+}
@@ -0,0 +1,60 @@
+#ifndef SYSTICK_H
+# define SYSTICK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @defgroup systick System tick <systick.h>
+ * @code #include <systick.h> @endcode
+ *
+ * @brief 1 ms system tick on Timer2 and the millis()/micros() clock.
+ *
+ * Timer2 runs in CTC mode with prescaler 64 and OCR2A = 249, so the
+ * compare interrupt comes every 1.000 ms (the plain overflow would be
+ * 1.024 ms). The tick also drives the front panel scan (input_tick()).
+ * @{
+ */
+
+// -- Includes -------------------------------------------------------
+#include <stdint.h>
+
+
+// -- Defines --------------------------------------------------------
+#define SYSTICK_TOP     249     /**< @brief OCR2A, 250 counts of 4 us */
+#define SYSTICK_US        4     /**< @brief Microseconds per timer count */
+
+
+// -- Function prototypes --------------------------------------------
+/**
+ * @brief  Start the 1 ms tick on Timer2.
+ * @return none
+ */
+void systick_init(void);
+
+
+/**
+ * @brief  Milliseconds since systick_init(), wraps after 49 days.
+ *         Compare with (uint32_t)(now - then) or cast to 16 bits for
+ *         intervals below 65 s.
+ * @return Time in ms
+ */
+uint32_t millis(void);
+
+
+/**
+ * @brief  Microseconds since systick_init() with 4 us resolution, for
+ *         measuring short durations. Wraps after 71 minutes.
+ * @return Time in us
+ */
+uint32_t micros(void);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,119 @@
+/*
+ * Binary telemetry: COBS framed, CRC protected records with per-type
+ * rate limits.
+ */
+
+// -- Includes -------------------------------------------------------
+#include <avr/io.h>
+#include <util/crc16.h>
+#include <telemetry.h>
+#include <systick.h>
+#include <uart.h>
+
+#define RECORD_MAX  (1 + 4 + TELEMETRY_PAYLOAD_MAX + 2)
+#define FRAME_MAX   (RECORD_MAX + 1 + 2)    // COBS overhead, two delimiters
+
+#if RECORD_MAX > 254
+# error "a record must fit into one COBS block"
+#endif
+
+
+// -- Local variables ------------------------------------------------
+static uint8_t enabled;
+static uint16_t interval[TLM_TYPES];
+static uint16_t lastSent[TLM_TYPES];
+static uint8_t sentOnce[TLM_TYPES];
+static uint16_t dropped;
+
+
+// -- Local functions ------------------------------------------------
+// COBS: every zero is replaced by the distance to the next one; the
+// record is shorter than 254 bytes, so there is a single block
+static uint8_t cobs_encode(const uint8_t *src, uint8_t len, uint8_t *dst)
+{
+    uint8_t code = 1;
+    uint8_t codePos = 0;
+    uint8_t out = 1;
+
+    for (uint8_t i = 0; i < len; i++) {
+        if (src[i] == 0) {
+            dst[codePos] = code;
+            codePos = out++;
+            code = 1;
+        }
+        else {
+            dst[out++] = src[i];
+            code++;
+        }
+    }
+    dst[codePos] = code;
+    return out;
+}
+
+
+// -- Function definitions -------------------------------------------
+void telemetry_enable(uint8_t on)
+{
+    enabled = on;
+    dropped = 0;
+    for (uint8_t i = 0; i < TLM_TYPES; i++) sentOnce[i] = 0;
+}
+
+
+uint8_t telemetry_enabled(void)
+{
+    return enabled;
+}
+
+
+void telemetry_set_rate(uint8_t type, uint16_t ms)
+{
+    if (type < TLM_TYPES) interval[type] = ms;
+}
+
+
+uint8_t telemetry_due(uint8_t type)
+{
+    if (!enabled || type >= TLM_TYPES) return 0;
+    if (!sentOnce[type]) return 1;
+    return (uint16_t)((uint16_t)millis() - lastSent[type]) >= interval[type];
+}
+
+
+uint8_t telemetry_send(uint8_t type, const void *payload, uint8_t len)
+{
+    uint8_t record[RECORD_MAX];
+    uint8_t frame[FRAME_MAX];
+    uint32_t now = millis();
+    uint16_t crc = 0;
+    uint8_t n = 0;
+
+    if (!telemetry_due(type) || len > TELEMETRY_PAYLOAD_MAX) return 0;
+
+    record[n++] = type;
+    for (uint8_t i = 0; i < 4; i++) record[n++] = now >> (8 * i);
+    for (uint8_t i = 0; i < len; i++) record[n++] = ((const uint8_t *)payload)[i];
+    for (uint8_t i = 0; i < n; i++) crc = _crc_xmodem_update(crc, record[i]);
+    record[n++] = crc;
+    record[n++] = crc >> 8;
+
+    frame[0] = 0;
+    uint8_t size = 1 + cobs_encode(record, n, frame + 1);
+    frame[size++] = 0;
+
+    if (uart_tx_free() < size) {
+        dropped++;
+        return 0;
+    }
+    uart_write(frame, size);                // fits, no wait
+
+    lastSent[type] = now;
+    sentOnce[type] = 1;
+    return 1;
+}
+
+
+uint16_t telemetry_dropped(void)
+{
+    return dropped;
+}
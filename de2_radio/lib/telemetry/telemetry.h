@@ -0,0 +1,105 @@
+#ifndef TELEMETRY_H
+# define TELEMETRY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @defgroup telemetry Binary telemetry <telemetry.h>
+ * @code #include <telemetry.h> @endcode
+ *
+ * @brief COBS framed binary records over the UART.
+ *
+ * A record is
+ *
+ *     type (1) | millis() (4, LE) | payload | CRC-16/XMODEM (2, LE)
+ *
+ * with the CRC over type, time and payload. It is COBS encoded and sent
+ * between two 0x00 delimiters, so a receiver resynchronises on the next
+ * zero byte after noise or interleaved text. tools/tlm2csv.py decodes the
+ * stream.
+ *
+ * Each type has a minimum interval; records that come sooner, or that do
+ * not fit into the transmit buffer, are dropped and counted rather than
+ * waited for.
+ * @{
+ */
+
+// -- Includes -------------------------------------------------------
+#include <stdint.h>
+
+
+// -- Defines --------------------------------------------------------
+#define TELEMETRY_BAUD    500000    /**< @brief Exact at 16 MHz with U2X */
+#define TELEMETRY_PAYLOAD_MAX 16    /**< @brief Longest payload in bytes */
+
+/** @brief Record types */
+enum {
+    TLM_SIGNAL = 1,     /**< @brief rssi u8, flags u8 (ST, RDSS, AFCRL), READCHAN u16 */
+    TLM_RDS,            /**< @brief blocks A-D u16, BLER u8 (A in bits 7:6) */
+    TLM_TWI,            /**< @brief starts u16, bytes u16, nacks u16 since the last one */
+    TLM_LOOP,           /**< @brief worst task us u32, worst tick us u32, load % u8, dropped u16 */
+    TLM_LOG,            /**< @brief format address u16, level u8, queued ms u16, args u16 u16 */
+    TLM_TYPES
+};
+
+
+// -- Function prototypes --------------------------------------------
+/**
+ * @brief  Start or stop sending. The UART baud rate is up to the caller.
+ * @param  on Non-zero to send records
+ * @return none
+ */
+void telemetry_enable(uint8_t on);
+
+
+/**
+ * @brief  Sending is enabled.
+ * @return 1 if enabled
+ */
+uint8_t telemetry_enabled(void);
+
+
+/**
+ * @brief  Set the minimum interval of a record type.
+ * @param  type Record type
+ * @param  ms Minimum time between two records, 0 = no limit
+ * @return none
+ */
+void telemetry_set_rate(uint8_t type, uint16_t ms);
+
+
+/**
+ * @brief  A record of this type would not be rate limited now. Lets the
+ *         caller skip collecting data that would be dropped.
+ * @param  type Record type
+ * @return 1 if due
+ */
+uint8_t telemetry_due(uint8_t type);
+
+
+/**
+ * @brief  Frame and queue a record, never blocks.
+ * @param  type Record type
+ * @param  payload Payload bytes
+ * @param  len Payload length, up to TELEMETRY_PAYLOAD_MAX
+ * @return 1 if queued, 0 if disabled, rate limited or no room
+ */
+uint8_t telemetry_send(uint8_t type, const void *payload, uint8_t len);
+
+
+/**
+ * @brief  Records dropped for lack of transmit buffer space.
+ * @return Count since telemetry_enable()
+ */
+uint16_t telemetry_dropped(void);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -8,6 +8,11 @@
 
 // -- Includes -------------------------------------------------------
 #include <twi.h>
+#include <hal.h>
+
+
+// -- Local variables ------------------------------------------------
+static twi_stats_t busStats;
 
 
 // -- Functions ------------------------------------------------------
@@ -29,6 +34,8 @@ void twi_init(void)
 }
 
 
+#ifdef __AVR__
+
 /*
  * Function: twi_start()
  * Purpose:  Start communication on I2C/TWI bus.
@@ -39,6 +46,7 @@ void twi_start(void)
     /* Send Start condition */
     TWCR = (1<<TWINT) | (1<<TWSTA) | (1<<TWEN);
     while ((TWCR & (1<<TWINT)) == 0);
+    busStats.starts++;
 }
 
 
@@ -59,6 +67,7 @@ uint8_t twi_write(uint8_t data)
 
     /* Check value of TWI status register */
     twi_status = TWSR & 0xf8;
+    busStats.bytes++;
 
     /* Status Code:
          - 0x18: SLA+W has been transmitted and ACK received
@@ -67,8 +76,9 @@ uint8_t twi_write(uint8_t data)
     */
     if (twi_status == 0x18 || twi_status == 0x28 || twi_status == 0x40)
         return 0;   /* ACK received */
-    else
-        return 1;   /* NACK received */
+
+    busStats.nacks++;
+    return 1;       /* NACK received */
 }
 
 
@@ -86,6 +96,7 @@ uint8_t twi_read(uint8_t ack)
     else
         TWCR = (1<<TWINT) | (1<<TWEN);
     while ((TWCR & (1<<TWINT)) == 0);
+    busStats.bytes++;
 
     return (TWDR);
 }
@@ -101,6 +112,44 @@ void twi_stop(void)
     TWCR = (1<<TWINT) | (1<<TWSTO) | (1<<TWEN);
 }
 
+#else
+
+/*
+ * Host build: the same bus protocol on the simulated bus of the HAL, the
+ * TWI registers keep only the bit rate.
+ */
+void twi_start(void)
+{
+    hal_native_twi_start();
+    busStats.starts++;
+}
+
+
+uint8_t twi_write(uint8_t data)
+{
+    busStats.bytes++;
+    if (hal_native_twi_write(data) == 0)
+        return 0;   /* ACK received */
+
+    busStats.nacks++;
+    return 1;       /* NACK received */
+}
+
+
+uint8_t twi_read(uint8_t ack)
+{
+    busStats.bytes++;
+    return hal_native_twi_read(ack);
+}
+
+
+void twi_stop(void)
+{
+    hal_native_twi_stop();
+}
+
+#endif
+
 
 /*
  * Function: twi_test_address()
@@ -156,3 +205,22 @@ void twi_readfrom_mem_into(uint8_t addr, uint8_t memaddr, volatile uint8_t *buf,
         twi_stop();
     }
 }
+
+
+/*
+ * Function: twi_get_stats()
+ * Purpose:  Copy the bus activity counters, optionally restart them.
+ * Input:    stats Destination
+ *           clear Non-zero to reset the counters
+ * Returns:  none
+ */
+void twi_get_stats(twi_stats_t *stats, uint8_t clear)
+{
+    *stats = busStats;
+    if (clear)
+    {
+        busStats.starts = 0;
+        busStats.bytes = 0;
+        busStats.nacks = 0;
+    }
+}
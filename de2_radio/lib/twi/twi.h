@@ -61,6 +61,15 @@ extern "C" {
 #define PIN(_x) (*(&_x - 2)) /**< @brief Address of input register of port _x */
 
 
+// -- Types ----------------------------------------------------------
+/** @brief Bus activity counters, see twi_get_stats() */
+typedef struct {
+    uint16_t starts;    /**< @brief Start conditions */
+    uint16_t bytes;     /**< @brief Bytes written (incl. addresses) and read */
+    uint16_t nacks;     /**< @brief Writes that were not acknowledged */
+} twi_stats_t;
+
+
 // -- Function prototypes --------------------------------------------
 /**
  * @brief  Initialize TWI unit, enable internal pull-ups, and set SCL frequency.
@@ -131,6 +140,16 @@ uint8_t twi_test_address(uint8_t addr);
  */
 void twi_readfrom_mem_into(uint8_t addr, uint8_t memaddr, volatile uint8_t *buf, uint8_t nbytes);
 
+
+/**
+ * @brief  Bus activity since the last call with clear set. The counters
+ *         wrap at 65536.
+ * @param  stats Filled with the counters
+ * @param  clear Non-zero to restart counting
+ * @return none
+ */
+void twi_get_stats(twi_stats_t *stats, uint8_t clear);
+
 /** @} */
 
 
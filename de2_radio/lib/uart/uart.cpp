@@ -13,7 +13,8 @@
 *
 *   The UART_RX_BUFFER_SIZE and UART_TX_BUFFER_SIZE variables define
 *   the buffer size in bytes. Note that these variables must be a
-*   power of 2.
+*   power of 2, at most 128. The buffers are Ring<> objects (ring.h),
+*   which the ISRs and the main loop share without disabling interrupts.
 *
 *  USAGE:
 *   Refere to the header file uart.h for a description of the routines.
@@ -39,23 +40,11 @@
 #include <avr/io.h>
 #include <avr/interrupt.h>
 #include <avr/pgmspace.h>
+#include <string.h>
+#include <util/atomic.h>
 #include "uart.h"
-
-
-/*
- *  constants and macros
- */
-
-/* size of RX/TX buffers */
-#define UART_RX_BUFFER_MASK ( UART_RX_BUFFER_SIZE - 1)
-#define UART_TX_BUFFER_MASK ( UART_TX_BUFFER_SIZE - 1)
-
-#if ( UART_RX_BUFFER_SIZE & UART_RX_BUFFER_MASK )
-# error RX buffer size is not a power of 2
-#endif
-#if ( UART_TX_BUFFER_SIZE & UART_TX_BUFFER_MASK )
-# error TX buffer size is not a power of 2
-#endif
+#include "ring.h"
+#include "hal.h"
 
 
 #if defined(__AVR_AT90S2313__) || defined(__AVR_AT90S4414__) || defined(__AVR_AT90S8515__) || \
@@ -338,21 +327,16 @@
 /*
  *  module global variables
  */
-static volatile unsigned char UART_TxBuf[UART_TX_BUFFER_SIZE];
-static volatile unsigned char UART_RxBuf[UART_RX_BUFFER_SIZE];
-static volatile unsigned char UART_TxHead;
-static volatile unsigned char UART_TxTail;
-static volatile unsigned char UART_RxHead;
-static volatile unsigned char UART_RxTail;
+static Ring<unsigned char, UART_TX_BUFFER_SIZE> UART_TxBuf;
+static Ring<unsigned char, UART_RX_BUFFER_SIZE> UART_RxBuf;
 static volatile unsigned char UART_LastRxError;
+static volatile unsigned char UART_TxActive;
+static unsigned char UART_TxPolicy = UART_TX_BLOCK;
+static uart_stats_t UART_Stats;     /* rxPeak, rxDropped written by the ISR */
 
 #if defined( ATMEGA_USART1 )
-static volatile unsigned char UART1_TxBuf[UART_TX_BUFFER_SIZE];
-static volatile unsigned char UART1_RxBuf[UART_RX_BUFFER_SIZE];
-static volatile unsigned char UART1_TxHead;
-static volatile unsigned char UART1_TxTail;
-static volatile unsigned char UART1_RxHead;
-static volatile unsigned char UART1_RxTail;
+static Ring<unsigned char, UART_TX_BUFFER_SIZE> UART1_TxBuf;
+static Ring<unsigned char, UART_RX_BUFFER_SIZE> UART1_RxBuf;
 static volatile unsigned char UART1_LastRxError;
 #endif
 
@@ -364,7 +348,6 @@ ISR(UART0_RECEIVE_INTERRUPT)
  * Purpose:  called when the UART has received a character
  **************************************************************************/
 {
-    unsigned char tmphead;
     unsigned char data;
     unsigned char usr;
     unsigned char lastRxError = 0;
@@ -385,20 +368,16 @@ ISR(UART0_RECEIVE_INTERRUPT)
     lastRxError = usr & (_BV(FE) | _BV(DOR) );
     #endif
 
-    /* calculate buffer index */
-    tmphead = ( UART_RxHead + 1) & UART_RX_BUFFER_MASK;
-
-    if (tmphead == UART_RxTail)
+    /* store received data in buffer */
+    if (!UART_RxBuf.push(data))
     {
         /* error: receive buffer overflow */
         lastRxError = UART_BUFFER_OVERFLOW >> 8;
+        UART_Stats.rxDropped++;
     }
-    else
+    else if (UART_RxBuf.count() > UART_Stats.rxPeak)
     {
-        /* store new index */
-        UART_RxHead = tmphead;
-        /* store received data in buffer */
-        UART_RxBuf[tmphead] = data;
+        UART_Stats.rxPeak = UART_RxBuf.count();
     }
     UART_LastRxError |= lastRxError;
 }
@@ -411,16 +390,18 @@ ISR(UART0_TRANSMIT_INTERRUPT)
  * Purpose:  called when the UART is ready to transmit the next byte
  **************************************************************************/
 {
-    unsigned char tmptail;
+    unsigned char data;
 
 
-    if (UART_TxHead != UART_TxTail)
+    if (UART_TxBuf.pop(data))
     {
-        /* calculate and store new buffer index */
-        tmptail     = (UART_TxTail + 1) & UART_TX_BUFFER_MASK;
-        UART_TxTail = tmptail;
-        /* get one byte from buffer and write it to UART */
-        UART0_DATA = UART_TxBuf[tmptail]; /* start transmission */
+        /* write the next byte from the buffer to the UART */
+        UART0_DATA = data; /* start transmission */
+#if defined(TXC0)
+        /* clear TXC (write 1, keep U2X), uart_flush_tx() waits for it */
+        UART0_STATUS = (UART0_STATUS & _BV(UART0_BIT_U2X)) | _BV(TXC0);
+        UART_TxActive = 1;
+#endif
     }
     else
     {
@@ -438,10 +419,8 @@ ISR(UART0_TRANSMIT_INTERRUPT)
  **************************************************************************/
 void uart_init(unsigned int baudrate)
 {
-    UART_TxHead = 0;
-    UART_TxTail = 0;
-    UART_RxHead = 0;
-    UART_RxTail = 0;
+    UART_TxBuf.clear();
+    UART_RxBuf.clear();
 
     #ifdef UART_TEST
     # ifndef UART0_BIT_U2X
@@ -467,8 +446,14 @@ void uart_init(unsigned int baudrate)
         UART0_STATUS = (1 << UART0_BIT_U2X); // Enable 2x speed
         #endif
     }
+    #if UART0_BIT_U2X
+    else
+    {
+        UART0_STATUS = 0;   // back to 1x after a double speed init
+    }
+    #endif
     #if defined(UART0_UBRRH)
-    UART0_UBRRH = (unsigned char) ((baudrate >> 8) & 0x80);
+    UART0_UBRRH = (unsigned char) ((baudrate >> 8) & 0x0F);  /* UBRR bits 11:8, not the U2X flag */
     #endif
     UART0_UBRRL = (unsigned char) (baudrate & 0x00FF);
 
@@ -493,26 +478,17 @@ void uart_init(unsigned int baudrate)
  **************************************************************************/
 unsigned int uart_getc(void)
 {
-    unsigned char tmptail;
     unsigned char data;
     unsigned char lastRxError;
 
 
-    if (UART_RxHead == UART_RxTail)
+    /* get data from receive buffer */
+    if (!UART_RxBuf.pop(data))
     {
         return UART_NO_DATA; /* no data available */
     }
-
-    /* calculate buffer index */
-    tmptail = (UART_RxTail + 1) & UART_RX_BUFFER_MASK;
-
-    /* get data from receive buffer */
-    data        = UART_RxBuf[tmptail];
     lastRxError = UART_LastRxError;
 
-    /* store buffer index */
-    UART_RxTail = tmptail;
-
     UART_LastRxError = 0;
     return (lastRxError << 8) + data;
 }/* uart_getc */
@@ -525,22 +501,113 @@ unsigned int uart_getc(void)
  **************************************************************************/
 void uart_putc(unsigned char data)
 {
-    unsigned char tmphead;
+    uart_write(&data, 1);
+}/* uart_putc */
 
+/*************************************************************************
+ * Function: uart_write()
+ * Purpose:  write bytes to ringbuffer, full buffer handled by the policy
+ * Input:    bytes and their number
+ * Returns:  number of bytes queued
+ **************************************************************************/
+unsigned char uart_write(const void *buf, unsigned char len)
+{
+    const unsigned char *p = (const unsigned char *)buf;
+    unsigned char done = 0;
 
-    tmphead = (UART_TxHead + 1) & UART_TX_BUFFER_MASK;
+    if (UART_TxPolicy == UART_TX_DROP_OLDEST && len > UART_TxBuf.space())
+    {
+        /* more than the whole buffer: only the newest bytes can stay */
+        if (len > UART_TX_BUFFER_SIZE)
+        {
+            UART_Stats.txDropped += len - UART_TX_BUFFER_SIZE;
+            p   += len - UART_TX_BUFFER_SIZE;
+            len  = UART_TX_BUFFER_SIZE;
+        }
+        /* the ISR is the consumer, keep it out while the tail moves */
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            UART_Stats.txDropped += UART_TxBuf.discard(len - UART_TxBuf.space());
+        }
+    }
 
-    while (tmphead == UART_TxTail)
+    for (;;)
     {
-        ;/* wait for free space in buffer */
+        unsigned char n = UART_TxBuf.push(p + done, len - done);
+        done += n;
+        if (n)
+        {
+            /* enable UDRE interrupt */
+            UART0_CONTROL |= _BV(UART0_UDRIE);
+        }
+        if (done == len || UART_TxPolicy != UART_TX_BLOCK)
+            break;
+        /* wait for free space in buffer */
+        hal_spin();
     }
 
-    UART_TxBuf[tmphead] = data;
-    UART_TxHead         = tmphead;
+    if (UART_TxBuf.count() > UART_Stats.txPeak)
+        UART_Stats.txPeak = UART_TxBuf.count();
+    UART_Stats.txDropped += len - done;
+    return done;
+}/* uart_write */
 
-    /* enable UDRE interrupt */
-    UART0_CONTROL |= _BV(UART0_UDRIE);
-}/* uart_putc */
+/*************************************************************************
+ * Function: uart_set_tx_policy()
+ * Purpose:  select what happens when the transmit ringbuffer is full
+ * Input:    UART_TX_BLOCK, UART_TX_DROP_NEWEST or UART_TX_DROP_OLDEST
+ * Returns:  previous policy
+ **************************************************************************/
+unsigned char uart_set_tx_policy(unsigned char policy)
+{
+    unsigned char previous = UART_TxPolicy;
+    UART_TxPolicy = policy;
+    return previous;
+}/* uart_set_tx_policy */
+
+/*************************************************************************
+ * Function: uart_get_stats()
+ * Purpose:  buffer high-water marks and drop counters
+ * Input:    structure to fill, non-zero to restart
+ * Returns:  none
+ **************************************************************************/
+void uart_get_stats(uart_stats_t *stats, unsigned char clear)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        *stats = UART_Stats;
+        if (clear)
+            memset(&UART_Stats, 0, sizeof(UART_Stats));
+    }
+}/* uart_get_stats */
+
+/*************************************************************************
+ * Function: uart_flush_tx()
+ * Purpose:  wait until all buffered data has left the transmitter
+ * Returns:  none
+ **************************************************************************/
+void uart_flush_tx(void)
+{
+    while (UART0_CONTROL & _BV(UART0_UDRIE))
+        hal_spin();                         /* ring buffer not yet empty */
+#if defined(TXC0)
+    if (UART_TxActive) {
+        while (!(UART0_STATUS & _BV(TXC0)))
+            hal_spin();                     /* last frame still shifting out */
+        UART_TxActive = 0;
+    }
+#endif
+}/* uart_flush_tx */
+
+/*************************************************************************
+ * Function: uart_tx_free()
+ * Purpose:  free space in the transmit ringbuffer
+ * Returns:  number of bytes that can be put without blocking
+ **************************************************************************/
+unsigned char uart_tx_free(void)
+{
+    return UART_TxBuf.space();
+}/* uart_tx_free */
 
 /*************************************************************************
  * Function: uart_puts()
@@ -550,8 +617,16 @@ void uart_putc(unsigned char data)
  **************************************************************************/
 void uart_puts(const char *s)
 {
-    while (*s)
-        uart_putc(*s++);
+    size_t len = strlen(s);
+
+    while (len)
+    {
+        /* in blocks the length argument can hold, the policy applies to each */
+        unsigned char n = len > 255 ? 255 : len;
+        uart_write(s, n);
+        s   += n;
+        len -= n;
+    }
 }/* uart_puts */
 
 /*************************************************************************
@@ -562,7 +637,7 @@ void uart_puts(const char *s)
  **************************************************************************/
 void uart_puts_p(const char *progmem_s)
 {
-    register char c;
+    char c;
 
     while ( (c = pgm_read_byte(progmem_s++)) )
         uart_putc(c);
@@ -580,7 +655,6 @@ ISR(UART1_RECEIVE_INTERRUPT)
  * Purpose:  called when the UART1 has received a character
  **************************************************************************/
 {
-    unsigned char tmphead;
     unsigned char data;
     unsigned char usr;
     unsigned char lastRxError;
@@ -593,21 +667,12 @@ ISR(UART1_RECEIVE_INTERRUPT)
     /* get FEn (Frame Error) DORn (Data OverRun) UPEn (USART Parity Error) bits */
     lastRxError = usr & (_BV(FE1) | _BV(DOR1) | _BV(UPE1) );
 
-    /* calculate buffer index */
-    tmphead = ( UART1_RxHead + 1) & UART_RX_BUFFER_MASK;
-
-    if (tmphead == UART1_RxTail)
+    /* store received data in buffer */
+    if (!UART1_RxBuf.push(data))
     {
         /* error: receive buffer overflow */
         lastRxError = UART_BUFFER_OVERFLOW >> 8;
     }
-    else
-    {
-        /* store new index */
-        UART1_RxHead = tmphead;
-        /* store received data in buffer */
-        UART1_RxBuf[tmphead] = data;
-    }
     UART1_LastRxError |= lastRxError;
 }
 
@@ -619,16 +684,13 @@ ISR(UART1_TRANSMIT_INTERRUPT)
  * Purpose:  called when the UART1 is ready to transmit the next byte
  **************************************************************************/
 {
-    unsigned char tmptail;
+    unsigned char data;
 
 
-    if (UART1_TxHead != UART1_TxTail)
+    if (UART1_TxBuf.pop(data))
     {
-        /* calculate and store new buffer index */
-        tmptail      = (UART1_TxTail + 1) & UART_TX_BUFFER_MASK;
-        UART1_TxTail = tmptail;
-        /* get one byte from buffer and write it to UART */
-        UART1_DATA = UART1_TxBuf[tmptail]; /* start transmission */
+        /* write the next byte from the buffer to the UART */
+        UART1_DATA = data; /* start transmission */
     }
     else
     {
@@ -646,10 +708,8 @@ ISR(UART1_TRANSMIT_INTERRUPT)
  **************************************************************************/
 void uart1_init(unsigned int baudrate)
 {
-    UART1_TxHead = 0;
-    UART1_TxTail = 0;
-    UART1_RxHead = 0;
-    UART1_RxTail = 0;
+    UART1_TxBuf.clear();
+    UART1_RxBuf.clear();
 
     # ifdef UART_TEST
     #  ifndef UART1_BIT_U2X
@@ -675,7 +735,13 @@ void uart1_init(unsigned int baudrate)
         UART1_STATUS = (1 << UART1_BIT_U2X); // Enable 2x speed
         # endif
     }
-    UART1_UBRRH = (unsigned char) ((baudrate >> 8) & 0x80);
+    # if UART1_BIT_U2X
+    else
+    {
+        UART1_STATUS = 0;   // back to 1x after a double speed init
+    }
+    # endif
+    UART1_UBRRH = (unsigned char) ((baudrate >> 8) & 0x0F);  /* UBRR bits 11:8, not the U2X flag */
     UART1_UBRRL = (unsigned char) baudrate;
 
     /* Enable USART receiver and transmitter and receive complete interrupt */
@@ -697,26 +763,17 @@ void uart1_init(unsigned int baudrate)
  **************************************************************************/
 unsigned int uart1_getc(void)
 {
-    unsigned char tmptail;
-    unsigned int data;
+    unsigned char data;
     unsigned char lastRxError;
 
 
-    if (UART1_RxHead == UART1_RxTail)
+    /* get data from receive buffer */
+    if (!UART1_RxBuf.pop(data))
     {
         return UART_NO_DATA; /* no data available */
     }
-
-    /* calculate buffer index */
-    tmptail = (UART1_RxTail + 1) & UART_RX_BUFFER_MASK;
-
-    /* get data from receive buffer */
-    data        = UART1_RxBuf[tmptail];
     lastRxError = UART1_LastRxError;
 
-    /* store buffer index */
-    UART1_RxTail = tmptail;
-
     UART1_LastRxError = 0;
     return (lastRxError << 8) + data;
 }/* uart1_getc */
@@ -729,19 +786,11 @@ unsigned int uart1_getc(void)
  **************************************************************************/
 void uart1_putc(unsigned char data)
 {
-    unsigned char tmphead;
-
-
-    tmphead = (UART1_TxHead + 1) & UART_TX_BUFFER_MASK;
-
-    while (tmphead == UART1_TxTail)
+    while (!UART1_TxBuf.push(data))
     {
         ;/* wait for free space in buffer */
     }
 
-    UART1_TxBuf[tmphead] = data;
-    UART1_TxHead         = tmphead;
-
     /* enable UDRE interrupt */
     UART1_CONTROL |= _BV(UART1_UDRIE);
 }/* uart1_putc */
@@ -754,8 +803,18 @@ void uart1_putc(unsigned char data)
  **************************************************************************/
 void uart1_puts(const char *s)
 {
-    while (*s)
-        uart1_putc(*s++);
+    size_t len = strlen(s);
+
+    while (len)
+    {
+        /* copy as much as fits at once, then let the ISR drain it */
+        unsigned char n = UART1_TxBuf.push((const unsigned char *)s, len > 255 ? 255 : len);
+        s   += n;
+        len -= n;
+
+        /* enable UDRE interrupt */
+        UART1_CONTROL |= _BV(UART1_UDRIE);
+    }
 }/* uart1_puts */
 
 /*************************************************************************
@@ -766,7 +825,7 @@ void uart1_puts(const char *s)
  **************************************************************************/
 void uart1_puts_p(const char *progmem_s)
 {
-    register char c;
+    char c;
 
     while ( (c = pgm_read_byte(progmem_s++)) )
         uart1_putc(c);
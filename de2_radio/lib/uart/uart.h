@@ -42,7 +42,8 @@ extern "C" {
  *  for buffering received and transmitted data.
  *
  *  The UART_RX_BUFFER_SIZE and UART_TX_BUFFER_SIZE constants define
- *  the size of the circular buffers in bytes. Note that these constants must be a power of 2.
+ *  the size of the circular buffers in bytes. Note that these constants must be a power of 2,
+ *  at most 128.
  *  You may need to adapt these constants to your target and your application by adding
  *  CDEFS += -DUART_RX_BUFFER_SIZE=nn -DUART_TX_BUFFER_SIZE=nn to your Makefile.
  *
@@ -112,6 +113,23 @@ extern "C" {
 #define UART_NO_DATA         0x0100 /**< @brief no receive data available   */
 
 
+/*
+** transmit overflow policy, see uart_set_tx_policy()
+*/
+#define UART_TX_BLOCK        0  /**< @brief wait for the ISR to make room (default) */
+#define UART_TX_DROP_NEWEST  1  /**< @brief keep what fits, drop the rest of the new data */
+#define UART_TX_DROP_OLDEST  2  /**< @brief discard the oldest unsent bytes to make room */
+
+
+/** @brief  Buffer statistics, see uart_get_stats() */
+typedef struct {
+    unsigned char txPeak;   /**< @brief Most bytes waiting in the transmit buffer */
+    unsigned char rxPeak;   /**< @brief Most bytes waiting in the receive buffer */
+    unsigned int txDropped; /**< @brief Bytes dropped by the transmit policy */
+    unsigned int rxDropped; /**< @brief Bytes lost to a full receive buffer */
+} uart_stats_t;
+
+
 /*
 ** function prototypes
 */
@@ -153,18 +171,55 @@ extern unsigned int uart_getc(void);
 
 /**
  *  @brief   Put byte to ringbuffer for transmitting via UART
+ *
+ *  Blocks while the ringbuffer is full, unless a dropping policy is set.
+ *
  *  @param   data byte to be transmitted
  *  @return  none
  */
 extern void uart_putc(unsigned char data);
 
 
+/**
+ *  @brief   Put bytes to ringbuffer for transmitting via UART
+ *
+ *  Copies the block at once rather than byte by byte. When it does not
+ *  fit, the transmit policy decides: wait, or drop bytes and count them
+ *  (uart_get_stats()) without ever waiting.
+ *
+ *  @param   buf bytes to be transmitted
+ *  @param   len number of bytes
+ *  @return  number of the given bytes that were queued
+ */
+extern unsigned char uart_write(const void *buf, unsigned char len);
+
+
+/**
+ *  @brief   Select what uart_putc(), uart_puts() and uart_write() do when
+ *           the transmit ringbuffer is full.
+ *  @param   policy UART_TX_BLOCK, UART_TX_DROP_NEWEST or UART_TX_DROP_OLDEST
+ *  @return  previous policy, to restore after a real-time section
+ */
+extern unsigned char uart_set_tx_policy(unsigned char policy);
+
+
+/**
+ *  @brief   Get the buffer high-water marks and drop counters, to size
+ *           UART_TX_BUFFER_SIZE and UART_RX_BUFFER_SIZE.
+ *  @param   stats filled with the values since the last clear
+ *  @param   clear non-zero to restart
+ *  @return  none
+ */
+extern void uart_get_stats(uart_stats_t *stats, unsigned char clear);
+
+
 /**
  *  @brief   Put string to ringbuffer for transmitting via UART
  *
  *  The string is buffered by the uart library in a circular buffer
  *  and one character at a time is transmitted to the UART using interrupts.
- *  Blocks if it can not write the whole string into the circular buffer.
+ *  Blocks if it can not write the whole string into the circular buffer,
+ *  unless a dropping policy is set.
  *
  *  @param   s string to be transmitted
  *  @return  none
@@ -172,12 +227,29 @@ extern void uart_putc(unsigned char data);
 extern void uart_puts(const char *s);
 
 
+/**
+ *  @brief   Wait until the ringbuffer is empty and the last byte has been
+ *           shifted out, e.g. before the clock is stopped for sleep.
+ *  @return  none
+ */
+extern void uart_flush_tx(void);
+
+
+/**
+ *  @brief   Free space in the transmit ringbuffer, for output that must
+ *           not wait for the UART (uart_putc() blocks when it is full).
+ *  @return  Number of bytes that can be put without blocking
+ */
+extern unsigned char uart_tx_free(void);
+
+
 /**
  * @brief    Put string from program memory to ringbuffer for transmitting via UART.
  *
  * The string is buffered by the uart library in a circular buffer
  * and one character at a time is transmitted to the UART using interrupts.
- * Blocks if it can not write the whole string into the circular buffer.
+ * Blocks if it can not write the whole string into the circular buffer,
+ * unless a dropping policy is set.
  *
  * @param    s program memory string to be transmitted
  * @return   none
@@ -4,10 +4,22 @@
 
 #include <avr/io.h>
 #include <avr/interrupt.h>
-#include <util/delay.h>
+#include <string.h>
 #include "freqselector.h"
 #include "timer.h"
 #include "gpio.h"
+#include "input.h"
+#include "presets.h"
+#include "bandmap.h"
+#include "journal.h"
+#include "log.h"
+#include "power.h"
+#include "pcint.h"
+#include "systick.h"
+#include "scheduler.h"
+#include "shell.h"
+#include "telemetry.h"
+#include "twi.h"
 extern "C"{
     #include "OLED_RDS.h"
     #include "oled.h"
@@ -16,134 +28,890 @@ extern "C"{
 
 #include "uart.h"
 
-const int presetFreqs[] = {
-    8760,  // Rádio Impuls, Vysílač Kojál
-    8820,  // Radio Kiss (JihM), Vysílač Hády
-    8890,  // Rádio Jih, Hodonín, Babí lom
-    8950,  // ČRo Radiožurnál, Husovice, ul. Míčkova 929/2
-    8990,  // Radio Wien, Rakousko, Vídeň 1 - Kahlenberg
-    9040,  // ČRo Vltava, Vysílač Hády
-    9100,  // Rádio Beat, Kohoutovice, Hotel Myslivna
-    9200,  // Radio Österreich 1, Rakousko, Vídeň 1 - Kahlenberg
-    9260,  // ČRo Plus, Vysílač Hády
-    9310,  // ČRo Brno, Vysílač Hády
-    9360,  // ČRo Brno, Hodonín, Babí lom
-    9460,  // Evropa 2, Blansko, Olešná
-    9510,  // ČRo Radiožurnál, Vysílač Kojál
-    9550,  // Radio Čas, Barvičova, Gymnázium
-    9640,  // Fajn rádio, Husovice, ul. Provazníkova 47
-    9680,  // Country Radio, Kohoutovice, ul. Voříškova 2
-    9760,  // Radio Hey, Katedrála sv. Petra a Pavla
-    9790,  // Radio Niederösterreich, Rakousko, Vídeň 1 - Kahlenberg
-    9810,  // Signál rádio, Kohoutovice, Hotel Myslivna
-    9900,  // Hitrádio City, Vysoké učení technické v Brně
-    9940,  // Color Music Rádio, Katedrála sv. Petra a Pavla
-    9990,  // Hitradio Ö3, Rakousko, Vídeň 1 - Kahlenberg
-   10020,  // ČRo Dvojka, Husovice, ul. Míčkova 929/2
-   10040,  // ČRo Vltava, Hodonín, Babí lom
-   10080,  // Hitrádio City, Barvičova, Gymnázium
-   10130,  // Rádio Prostor / BBC World Service, Vysílač Hády
-   10200,  // ČRo Dvojka, Vysílač Kojál
-   10250,  // oe24 Radio, Rakousko, Vídeň 1 - Kahlenberg
-   10300,  // Radio Krokodýl, Vysílač Hády
-   10340,  // Rádio Blaník (Morava a Slez.), Vysílač Hády
-   10380,  // radio FM4, Rakousko, Vídeň 1 - Kahlenberg
-   10410,  // Radio Kiss (JihM), Blansko, Zborovce
-   10450,  // Frekvence 1, Vysílač Kojál
-   10510,  // Rádio Jih, Kohoutovice, Hotel Myslivna
-   10550,  // Evropa 2, Vysílač Hády
-   10580,  // kronehit, Rakousko, Vídeň 1 - Kahlenberg
-   10620,  // ČRo Radiožurnál, Hodonín, Babí lom
-   10650,  // ČRo Brno, Vysílač Kojál
-   10700,  // Free Rádio, Kohoutovice, Hotel Myslivna
-   10750   // Radio Proglas, Vysílač Hády
-};
-FreqSelector freqSelector(presetFreqs, 39, PD6, PD5); // 50 ms debounce
+// #define FREQ_ENCODER  // rotary encoder on PD6/PD5 instead of the two preset buttons
+#ifdef FREQ_ENCODER
+FreqSelector freqSelector(8750, 10800, 10); // whole band, 100 kHz steps
+#define STANDBY_CHORD (INPUT_VOL_UP | INPUT_VOL_DOWN)
+#else
+FreqSelector freqSelector; // EEPROM presets, buttons via input module
+#define STANDBY_CHORD (INPUT_PREV | INPUT_NEXT)  // both held: standby
+#endif
 extern Si4703 radio;
 OledDisplay oled;
 static int lastFreq = -1; 
- 
+static journal_state_t state = { 10700, 15, 0, 0 };  // first boot defaults
 
-#define VOL_DOWN_PIN  PD7
-#define VOL_UP_PIN  PB0
+// Task periods (ms)
+#define PANEL_MS      10    // front panel events
+#define RADIO_MS      10    // tuner requests and STC polling
+#define DISPLAY_MS   250    // redraw and RDS scroll step
+#define SIGNAL_MS   1000    // RSSI/stereo indicator
+#define JOURNAL_MS   100    // state journal
+#define STATS_MS   10000    // worst task/tick time and CPU load over UART
+#define SHELL_MS      10    // serial commands, faster than 9600 Bd fills the buffer
+#define TELEMETRY_MS  20    // tuner status poll, RDS groups come every 88 ms
+#define SCAN_MS        2    // band scan step, one short I2C transfer
+#define REFRESH_MS   250    // band map refresh while muted
+#define REFRESH_HOP_MS 2000 // least time between two preset switch hops
 
+#define CONSOLE_BAUD  9600
 
+static sched_task_t bootTask, panelTask, radioTask, displayTask, flushTask;
+static sched_task_t signalTask, journalTask, standbyTask, statsTask;
+static sched_task_t shellTask, listTask, telemetryTask, baudTask;
+static sched_task_t scanTask, refreshTask, refreshPollTask;
 
-int main() {
-    
-    uart_init(UART_BAUD_SELECT(9600, F_CPU));
-    oled_init(OLED_DISP_ON);
-    sei();
-    
-    // Initialize UART for debugging
-    
-    uart_puts("Starting Si4703 FM Radio Receiver...\n");
-
-    // Initialize I2C (TWI)
-    //twi_init();
-    uart_puts("I2C Initialized.\n");
-
-    // Initialize Si4703
-
-    radio.start();
-    uart_puts("Si4703 Initialized.\n");
-
-    // Set frequency to 101.1 MHz
-    radio.setChannel(10700); // Frequency in 0.1 MHz steps
-    radio.powerDown();
-    radio.powerUp();
-    radio.start();
-
-    radio.setMute(true);
-    //radio.setMute(false); // Unmute audio
-    //radio.seekUp(); // Seek to the next available station
-    radio.setVolume(15); // Set volume to a medium level
-    uart_puts("Tuned to 101.1 MHz.\n");
-    FreqSelector::attach(&freqSelector);
-    
-    oled.setRdsText("HELLO FROM RADIO STREAMING SERVICE");
-    oled.setFrequency(radio.getChannel());
-    gpio_mode_input_pullup(&DDRD, VOL_DOWN_PIN);
-    gpio_mode_input_pullup(&DDRB, VOL_UP_PIN);
+// Front panel requests, carried out by the radio task when the tuner is idle
+static bool radioReady = false;     // powered up, no request accepted before
+static int8_t volPending = 0;
+static int8_t seekPending = 0;
+static int tunePending = 0;         // serial "tune"
+static bool muted = false;
+static bool mutePending = false;
+static bool inStandby = false;
 
-    while (1) {
-        // --- VOLUME UP ---
-        if (gpio_read(&PINB, VOL_UP_PIN) == 0) {
-            _delay_ms(30);
-            if (gpio_read(&PINB, VOL_UP_PIN) == 0) {
-                if (radio.getVolume() < 15) {
-                    radio.incVolume();
-                    oled.setVolume(radio.getVolume());
-                }
-                while (gpio_read(&PINB, VOL_UP_PIN) == 0);
-            }
+// Serial "scan": every channel into the band map, then back to the station
+static bool scanSave;               // replace the presets with the result
+static uint8_t scanReported;        // progress, % printed last
+static uint32_t scanFrom;
+
+// Band map refresh in audio gaps, see refresh_start()
+#define REFRESH_BATCH    8          // channels per batch while muted
+#define REFRESH_STANDBY 16          // channels before the tuner goes off
+static uint8_t refreshBuf[REFRESH_STANDBY];
+static uint32_t refreshHopAt;
+static bool standbyRefresh;         // one batch before the tuner goes off
+
+// Seek by the band map, see seek_start()
+#define SEEK_MAP_MISSES 2           // weak stations in a row before the chip seeks
+static int8_t mapSeek;              // direction of the map seek being checked
+static uint8_t mapMisses;
+static uint16_t scanMs;             // duration of the last complete scan
+static uint8_t scanStored;          // presets written by it, PRESET_NONE if none
+
+// Time-to-audio report for the running tune (boot, wake-up)
+enum { AUDIO_NONE, AUDIO_BOOT, AUDIO_WAKE };
+static uint8_t audioReport = AUDIO_NONE;
+static uint32_t audioFrom;
+
+
+
+// Shell replies; text and unit in program memory
+#define uart_put_uint(what, value, unit) uart_put_uint_p(PSTR(what), value, PSTR(unit))
+
+static void uart_put_uint_p(const char *what, uint32_t value, const char *unit)
+{
+    char buffer[11];
+    uart_puts_p(what);
+    ultoa(value, buffer, 10);
+    uart_puts(buffer);
+    uart_puts_p(unit);
+}
+
+
+static void sample_signal()
+{
+    oled.setSignal(radio.getRSSI(), radio.getST());
+}
+
+
+// Sends the frame one changed page per run, so a full frame (1 KB on
+// I2C, ~100 ms) does not hold up the other tasks
+static void display_flush()
+{
+    if (oled.flush()) sched_after(&flushTask, display_flush, 0);
+}
+
+// Redraw (changed spans only) and one RDS scroll step
+static void display_task()
+{
+    if (inStandby) return;
+    oled.update();
+    display_flush();
+}
+
+
+// --- BOOT ---
+// Cold boot as a chain of one-shot continuations. The tuner waits 500 ms
+// for its crystal and 110 ms for power up; the loop keeps running.
+static void boot_enable()
+{
+    radio.enable();  // the one and only power up
+    sched_every(&displayTask, display_task, DISPLAY_MS);  // splash until now
+    sched_after(&bootTask, [] {
+        audioReport = AUDIO_BOOT;
+        audioFrom = 0;
+        radio.bootConfigure(state.freq, state.volume, state.mono);
+    }, Si4703::POWERUP_MS);
+}
+
+// The splash page by page like any frame, then the panel on
+static void splash_flush()
+{
+    if (oled.flush()) {
+        sched_after(&flushTask, splash_flush, 0);
+        return;
+    }
+    oled_sleep(0);
+    LOG_INFO("Boot: first frame %u ms", millis());
+}
+
+static void boot_begin()
+{
+    radio.bootBegin();  // I2C up, crystal starts
+    sched_after(&bootTask, boot_enable, Si4703::XOSC_SETTLE_MS);
+
+    // panel off until the splash has overwritten its undefined RAM, so
+    // the splash is the first and only full frame on the bus
+    oled_init(OLED_DISP_OFF);
+    oled.showSplash();
+    sched_after(&flushTask, splash_flush, 0);
+}
+
+static void boot_release()
+{
+    radio.bootRelease();
+    sched_after(&bootTask, boot_begin, 1);
+}
+
+
+static void standby_enter();
+static void refresh_start(uint8_t count, int home);
+
+
+// --- FRONT PANEL ---
+// Drain all queued events. Repeats only add up here, so the radio sees at
+// most one volume change and one seek however many events piled up.
+static void panel_task()
+{
+    uint8_t ev;
+    while ((ev = input_get()) != INPUT_NONE) {
+        uint8_t type = INPUT_TYPE(ev);
+        uint8_t button = INPUT_BUTTON(ev);
+
+        if (inStandby) continue;
+
+        if (type == INPUT_PRESS && (input_state() & STANDBY_CHORD) == STANDBY_CHORD) {
+            // chord: no clicks, seeks or repeats from these presses
+            input_suppress();
+            standby_enter();
+            return;
+        }
+        if (button == INPUT_VOL_UP || button == INPUT_VOL_DOWN) {
+            // press, then auto-repeat while held
+            if (type == INPUT_PRESS || type == INPUT_LONG || type == INPUT_REPEAT)
+                volPending += (button == INPUT_VOL_UP) ? 1 : -1;
+        }
+        else if (type == INPUT_CLICK) {
+            // short press: next/previous preset
+            if (button == INPUT_NEXT) freqSelector.next();
+            else freqSelector.prev();
+        }
+        else if (type == INPUT_LONG || type == INPUT_REPEAT) {
+            // hold > 600 ms: seek in that direction, keep seeking while held
+            seekPending = (button == INPUT_NEXT) ? 1 : -1;
+        }
+    }
+}
+
+
+// --- RADIO ---
+// Seek by the band map: tune the next station it lists and check the
+// RSSI of that one tune. The chip's own seek (up to seconds, stops on
+// weak junk) only when the map is stale or keeps missing.
+static void seek_start(bool up, int from)
+{
+    if (bandmap_fresh() && mapMisses < SEEK_MAP_MISSES) {
+        uint8_t ch = bandmap_next(PRESET_CH(from), up);
+        if (ch != BANDMAP_NONE) {
+            mapSeek = up ? 1 : -1;
+            radio.tuneStart(PRESET_BAND_START + ch * PRESET_SPACING);
+            return;
+        }
+    }
+    LOG_DEBUG("seek: hardware from %u", from);
+    mapSeek = 0;
+    mapMisses = 0;
+    radio.seekStart(up);
+}
+
+// A tune or seek has finished: freq is the station, -1 if a seek found none
+static void tune_done(int freq)
+{
+    radioReady = true;
+    if (audioReport == AUDIO_BOOT) LOG_INFO("Boot: first audio %u ms", millis() - audioFrom);
+    if (audioReport == AUDIO_WAKE) LOG_INFO("Standby: wake to audio %u ms", millis() - audioFrom);
+    audioReport = AUDIO_NONE;
+    if (freq < 0) {
+        LOG_INFO("Seek: no station");
+        return;
+    }
+    bandmap_update(PRESET_CH(freq), radio.lastSignal());   // free with every tune
+    if (mapSeek) {
+        bool up = mapSeek > 0;
+        mapSeek = 0;
+        if ((radio.lastSignal() & BANDMAP_RSSI) < BANDMAP_STATION_RSSI) {
+            LOG_DEBUG("seek: map miss at %u", freq);
+            mapMisses++;
+            seek_start(up, freq);       // next one, or the chip
+            return;
+        }
+        mapMisses = 0;
+    }
+    state.freq = freq;
+    LOG_INFO("Tuned to frequency: %u kHz", freq);
+    oled.setFrequency(freq);
+    sample_signal();
+}
+
+// Polls a running tune/seek, otherwise starts the next request. One I2C
+// transaction of a few bytes per run instead of waiting for STC.
+static void radio_task()
+{
+    // a scan or refresh batch polls the tuner itself
+    if (sched_active(&scanTask) || sched_active(&refreshPollTask)) return;
+    if (radio.busy()) {
+        int freq = radio.pollOp();
+        if (freq != 0) tune_done(freq);
+        return;
+    }
+    if (!radioReady) return;
+
+    if (volPending) {
+        state.volume = radio.setVolume(state.volume + volPending); // clamps to 0-15
+        volPending = 0;
+        oled.setVolume(state.volume);
+        return;
+    }
+    if (mutePending) {
+        radio.setMute(!muted);      // DMUTE = 0 mutes
+        mutePending = false;
+        return;
+    }
+    if (tunePending) {
+        radio.tuneStart(tunePending);
+        tunePending = 0;
+        return;
+    }
+    if (seekPending) {
+        seek_start(seekPending > 0, state.freq);
+        seekPending = 0;
+        return;
+    }
+    int freq = freqSelector.get();
+    if (freq != lastFreq) {
+        lastFreq = freq;
+#ifndef FREQ_ENCODER
+        // the switch is an audio gap anyway: measure one channel in it
+        if (millis() - refreshHopAt >= REFRESH_HOP_MS) {
+            refreshHopAt = millis();
+            refresh_start(1, freq);
+            return;
         }
+#endif
+        radio.tuneStart(freq);
+    }
+}
+
+
+// --- BAND SCAN ---
+// Prints one station of the band map per run while the transmit buffer
+// has room, then the summary
+static void station_list_task()
+{
+    static uint8_t ch;
+    const uint8_t *map = bandmap_data();
+
+    if (!sched_active(&listTask)) {     // called at the end of the scan
+        ch = 0;
+        sched_every(&listTask, station_list_task, SHELL_MS);
+    }
+
+    while (ch < BANDMAP_CHANNELS && uart_tx_free() >= 32) {
+        if (bandmap_is_station(ch)) {
+            uart_put_uint("station ", PRESET_BAND_START + ch * PRESET_SPACING, "");
+            uart_put_uint(" rssi ", map[ch] & BANDMAP_RSSI, "");
+            if (map[ch] & BANDMAP_STEREO) uart_puts_P(" stereo\n");
+            else uart_puts_P("\n");
+        }
+        ch++;
+    }
+    if (ch >= BANDMAP_CHANNELS && uart_tx_free() >= 56) {
+        uart_put_uint("scan done in ", scanMs, " ms, ");
+        uart_put_uint("", bandmap_stations(nullptr, 0), " stations");
+        if (scanStored != PRESET_NONE) uart_put_uint(", ", scanStored, " presets saved");
+        uart_puts_P("\n");
+        sched_cancel(&listTask);
+    }
+}
+
+// Polls the scan every SCAN_MS; each run moves it by at most one I2C
+// transfer (tune start, STC check, or TUNE clear)
+static void scan_task()
+{
+    int freq = radio.pollOp();
+    if (freq == 0) {
+        uint8_t pct = (uint32_t)radio.scanDone() * 100 / radio.scanCount();
+        if (pct >= scanReported + 25 && pct < 100) {
+            scanReported = pct - pct % 25;
+            uart_put_uint("scan ", scanReported, " %\n");
+        }
+        return;
+    }
+    sched_cancel(&scanTask);
+    if (inStandby) return;              // aborted, the wake-up tunes anyway
+
+    scanMs = millis() - scanFrom;
+    bandmap_scanned();
+    scanStored = PRESET_NONE;
+    if (scanSave) {
+        uint8_t channels[PRESETS_MAX];
+        scanStored = presets_replace(channels, bandmap_stations(channels, PRESETS_MAX));
+#ifndef FREQ_ENCODER
+        uint8_t index = presets_find(state.freq);   // stay on the station
+        if (index != PRESET_NONE) freqSelector.select(index);
+        else freqSelector.reload();
+#endif
+    }
+    station_list_task();                // the scan has tuned back already
+}
+
+// The user wants the tuner: cut a refresh batch short
+static bool requests_pending()
+{
+    return volPending || mutePending || tunePending || seekPending ||
+           freqSelector.get() != lastFreq;
+}
+
+// Polls a refresh batch, stores what was measured
+static void refresh_poll()
+{
+    if (requests_pending()) radio.scanAbort();  // this channel, then home
+    int freq = radio.pollOp();
+    if (freq == 0) return;
+
+    sched_cancel(&refreshPollTask);
+    for (uint8_t i = 0; i < radio.scanDone(); i++) bandmap_refresh_store(refreshBuf[i]);
+    if (freq != state.freq) tune_done(freq);    // a preset switch hop
+}
+
+// Measures the next count channels of the refresh sweep, muted, and
+// tunes home afterwards. Used only where audio is interrupted anyway:
+// while muted, on a preset switch and before standby.
+static void refresh_start(uint8_t count, int home)
+{
+    radio.scanStart(refreshBuf, bandmap_refresh_next(), count, home);
+    sched_every(&refreshPollTask, refresh_poll, SCAN_MS);
+}
+
+static void refresh_task()
+{
+    if (!muted || mutePending || !radioReady || inStandby || radio.busy()) return;
+    if (requests_pending() || sched_active(&scanTask)) return;
+    refresh_start(REFRESH_BATCH, state.freq);
+}
+
+
+// --- STANDBY ---
+// Mute, tuner and display off, MCU in power down until any front panel
+// button (or the encoder) is touched. The Si4703 keeps its crystal
+// running (XOSCEN stays set), so waking needs only the 110 ms power up
+// and one tune instead of the 610 ms cold start.
+static void standby_sleep()
+{
+    // wait for a running tune, the chord release, the last EEPROM byte
+    // and the display stream; the EEPROM ISR does not run in power down
+    if (radio.busy()) {
+        radio_task();
+        return;
+    }
+    if (standbyRefresh) {
+        standbyRefresh = false;         // one batch before the tuner goes off
+        refresh_start(REFRESH_STANDBY, state.freq);
+        return;
+    }
+    if (input_state() || journal_busy() || oled_display_busy() || sched_active(&flushTask)) return;
+    sched_cancel(&standbyTask);
+
+    radio.setMute(false);           // DMUTE = 0: mute before the tuner goes off
+    radio.disable();
+    oled_sleep(YES);
+    do uart_flush_tx(); while (log_drain());
+
+    uint16_t slept = power_down(INPUT_VOL_UP, INPUT_ALL & 0xE0);
+
+    audioFrom = millis();
+    audioReport = AUDIO_WAKE;
+    input_suppress();               // the wake-up press does nothing else
+    radio.enable();
+    oled_sleep(0);
+    LOG_INFO("Standby: slept %u s", slept);
+
+    sched_after(&standbyTask, [] {
+        radio.bootConfigure(state.freq, state.volume, state.mono);
+        mutePending = muted;        // the wake-up configuration unmutes
+        inStandby = false;
+    }, Si4703::POWERUP_MS);
+}
+
+static void standby_enter()
+{
+    LOG_INFO("Standby");
+    standbyRefresh = radioReady;    // the tuner is on and configured
+    inStandby = true;
+    radioReady = false;             // requests wait until the wake-up tune
+    volPending = seekPending = 0;
+    mapSeek = 0;
+    tunePending = 0;
+    mutePending = false;            // muted stays, restored after the wake-up
+    radio.scanAbort();              // the channel being tuned just finishes
+    scanSave = false;
+    journal_commit();
+    sched_every(&standbyTask, standby_sleep, PANEL_MS);
+}
+
+
+// --- PERIODIC ---
+static void signal_task()
+{
+    if (radioReady && !radio.busy()) sample_signal();
+}
 
-        // --- VOLUME DOWN ---
-        if (gpio_read(&PIND, VOL_DOWN_PIN) == 0) {
-            _delay_ms(30);
-            if (gpio_read(&PIND, VOL_DOWN_PIN) == 0) {
-                if (radio.getVolume() > 0) {
-                    radio.decVolume();
-                    oled.setVolume(radio.getVolume());
-                }
-                while (gpio_read(&PIND, VOL_DOWN_PIN) == 0);
+static void journal_task()
+{
+    state.preset = freqSelector.index();
+    journal_update(&state, millis());  // saves in the background
+}
+
+static void print_stats()
+{
+    uart_put_uint("Worst task: ", sched_worst_us(nullptr), " us");
+    uart_put_uint(", timer tick ", sched_tick_us(), " us\n");
+}
+
+static void print_uart_stats()
+{
+    uart_stats_t uartStats;
+    uart_get_stats(&uartStats, 0);      // peaks since boot, to size the rings
+
+    uart_put_uint("UART peak tx ", uartStats.txPeak, "");
+    uart_put_uint("/", UART_TX_BUFFER_SIZE, "");
+    uart_put_uint(" rx ", uartStats.rxPeak, "");
+    uart_put_uint("/", UART_RX_BUFFER_SIZE, " B");
+    uart_put_uint(", dropped tx ", uartStats.txDropped, "");
+    uart_put_uint(" rx ", uartStats.rxDropped, "\n");
+}
+
+static void print_map_stats()
+{
+    bandmap_stats_t mapStats;
+    bandmap_get_stats(&mapStats);
+
+    if (mapStats.ageS == 0xffff) uart_puts_P("Band map: none");
+    else uart_put_uint("Band map: age ", mapStats.ageS, " s");
+    uart_put_uint(", sweep ", mapStats.sweepPct, " %");
+    uart_put_uint(", ", mapStats.sweeps, " sweeps");
+    uart_put_uint(", ", mapStats.refreshed, " ch\n");
+}
+
+static void stats_task()
+{
+    if (telemetry_enabled()) return;    // TLM_LOOP records instead
+
+    uint32_t awake, asleep;
+    uint8_t load = power_load(&awake, &asleep);
+
+    print_stats();
+    sched_reset_stats();
+    uart_put_uint("CPU load: ", load, " %");
+    uart_put_uint(", awake ", awake, " ms");
+    uart_put_uint(", asleep ", asleep, " ms\n");
+}
+
+
+// --- TELEMETRY ---
+// One 12 byte status read per run feeds the signal and RDS records; the
+// rate limits of the telemetry module decide what is actually sent.
+static void telemetry_task()
+{
+    static uint16_t lastRds[4];
+
+    if (radioReady && !radio.busy() && !inStandby) {
+        Si4703::Status st;
+        radio.getStatus(st);
+
+        uint8_t signal[4] = {
+            st.rssi,
+            (uint8_t)(st.stereo | st.rdsSync << 1 | st.afcRail << 2),
+            (uint8_t)st.channel, (uint8_t)(st.channel >> 8)
+        };
+        telemetry_send(TLM_SIGNAL, signal, sizeof(signal));
+
+        // RDSR stays set for ~40 ms, send each group once
+        if (st.rdsReady && memcmp(st.rds, lastRds, sizeof(lastRds))) {
+            uint8_t rds[9];
+            for (uint8_t i = 0; i < 4; i++) {
+                rds[2 * i] = st.rds[i];
+                rds[2 * i + 1] = st.rds[i] >> 8;
             }
+            rds[8] = st.bler;
+            if (telemetry_send(TLM_RDS, rds, sizeof(rds))) memcpy(lastRds, st.rds, sizeof(lastRds));
         }
-        int freq = freqSelector.get();
-        if (freq != lastFreq) {
-            lastFreq = freq;
-            radio.setChannel(freq);
-            uart_puts("Tuned to frequency: ");
-            char buffer[10];
-            itoa(freq, buffer, 10);
-            uart_puts(buffer);
-            uart_puts(" kHz\n");
-            oled.setFrequency(freq);
+    }
+
+    if (telemetry_due(TLM_TWI)) {
+        twi_stats_t bus;
+        twi_get_stats(&bus, 1);
+        uint8_t twi[6] = {
+            (uint8_t)bus.starts, (uint8_t)(bus.starts >> 8),
+            (uint8_t)bus.bytes, (uint8_t)(bus.bytes >> 8),
+            (uint8_t)bus.nacks, (uint8_t)(bus.nacks >> 8)
+        };
+        telemetry_send(TLM_TWI, twi, sizeof(twi));
+    }
+
+    if (telemetry_due(TLM_LOOP)) {
+        uint32_t task = sched_worst_us(nullptr);
+        uint32_t tick = sched_tick_us();
+        uint16_t lost = telemetry_dropped();
+        uint8_t loop[11] = {
+            (uint8_t)task, (uint8_t)(task >> 8), (uint8_t)(task >> 16), (uint8_t)(task >> 24),
+            (uint8_t)tick, (uint8_t)(tick >> 8), (uint8_t)(tick >> 16), (uint8_t)(tick >> 24),
+            power_load(nullptr, nullptr),
+            (uint8_t)lost, (uint8_t)(lost >> 8)
+        };
+        if (telemetry_send(TLM_LOOP, loop, sizeof(loop))) sched_reset_stats();
+    }
+}
+
+// Waits for the transmit buffer to drain, then sets the new rate and
+// starts or stops the records
+static bool telemetryOn = false;
+
+static void baud_switch()
+{
+    if (uart_tx_free() < UART_TX_BUFFER_SIZE) {
+        sched_after(&baudTask, baud_switch, 1);
+        return;
+    }
+    uart_flush_tx();
+    if (telemetryOn) {
+        uart_init(UART_BAUD_SELECT_DOUBLE_SPEED(TELEMETRY_BAUD, F_CPU));
+        telemetry_enable(1);
+        sched_every(&telemetryTask, telemetry_task, TELEMETRY_MS);
+    }
+    else {
+        uart_init(UART_BAUD_SELECT(CONSOLE_BAUD, F_CPU));
+    }
+}
+
+
+// --- SERIAL SHELL ---
+// Commands only record requests for the radio task or start a task, so
+// each one returns within a few ms (preset save: two EEPROM cells).
+static bool tuner_ready()
+{
+    if (inStandby) uart_puts_P("err standby\n");
+    else if (!radioReady || sched_active(&scanTask)) uart_puts_P("err busy\n");
+    else return true;
+    return false;
+}
+
+// "101.7" (MHz) or "10170" (10 kHz units) to 10 kHz units
+static int parse_freq(const char *s)
+{
+    char *end;
+    long freq = strtol(s, &end, 10);
+    if (*end == '.') {
+        end++;
+        freq = freq * 100 + (*end >= '0' && *end <= '9' ? (*end++ - '0') * 10 : 0);
+        if (*end >= '0' && *end <= '9') freq += *end++ - '0';
+    }
+    if (*end || freq < 8750 || freq > 10800) return 0;
+    return freq;
+}
+
+static void cmd_tune(uint8_t argc, char *argv[])
+{
+    int freq = argc > 1 ? parse_freq(argv[1]) : 0;
+    if (!freq) {
+        uart_puts_P("err tune <87.5-108.0>\n");
+        return;
+    }
+    if (!tuner_ready()) return;
+    tunePending = freq;
+    uart_puts_P("ok\n");
+}
+
+static void cmd_seek(uint8_t argc, char *argv[])
+{
+    int8_t dir = 0;
+    if (argc > 1 && strcmp(argv[1], "up") == 0) dir = 1;
+    if (argc > 1 && strcmp(argv[1], "down") == 0) dir = -1;
+    if (!dir) {
+        uart_puts_P("err seek up|down\n");
+        return;
+    }
+    if (!tuner_ready()) return;
+    seekPending = dir;
+    uart_puts_P("ok\n");
+}
+
+static void cmd_vol(uint8_t argc, char *argv[])
+{
+    if (argc < 2) {
+        uart_put_uint("vol ", state.volume, "\n");
+        return;
+    }
+    int vol = atoi(argv[1]);
+    if (vol < 0 || vol > 15) {
+        uart_puts_P("err vol <0-15>\n");
+        return;
+    }
+    if (!tuner_ready()) return;
+    volPending = vol - state.volume;
+    uart_puts_P("ok\n");
+}
+
+static void cmd_mute(uint8_t argc, char *argv[])
+{
+    bool on = !muted;               // no argument: toggle
+    if (argc > 1) on = strcmp(argv[1], "off") != 0;
+    if (!tuner_ready()) return;
+    muted = on;
+    mutePending = true;
+    if (on) uart_puts_P("ok muted\n");
+    else uart_puts_P("ok unmuted\n");
+}
+
+// Prints one preset per run while the transmit buffer has room
+static void preset_list_task()
+{
+    static uint8_t pos;
+    uint8_t count = presets_count();
+
+    if (!sched_active(&listTask)) {     // called by the command
+        pos = 0;
+        sched_every(&listTask, preset_list_task, SHELL_MS);
+    }
+
+    while (pos < count && uart_tx_free() >= 24) {
+        uart_put_uint("preset ", pos, " ");
+        uart_put_uint("", presets_get(pos), "\n");
+        pos++;
+    }
+    if (pos >= count && uart_tx_free() >= 16) {
+        uart_put_uint("ok ", count, " presets\n");
+        sched_cancel(&listTask);
+    }
+}
+
+static void cmd_preset(uint8_t argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "list") == 0) {
+        if (sched_active(&listTask)) uart_puts_P("err busy\n");
+        else preset_list_task();
+    }
+    else if (argc > 1 && strcmp(argv[1], "save") == 0) {
+        uint8_t index = presets_save(state.freq);
+        if (index == PRESET_NONE) {
+            uart_puts_P("err presets full\n");
+            return;
         }
-        oled.update();
+        freqSelector.reload();
+        uart_put_uint("ok preset ", index, "\n");
+    }
+    else {
+        uart_puts_P("err preset list|save\n");
+    }
+}
+
+static void cmd_scan(uint8_t argc, char *argv[])
+{
+    bool save = argc > 1 && strcmp(argv[1], "save") == 0;
+    if (argc > 1 && !save) {
+        uart_puts_P("err scan [save]\n");
+        return;
+    }
+    if (!tuner_ready()) return;
+    if (radio.busy() || tunePending || seekPending || sched_active(&listTask)) {
+        uart_puts_P("err busy\n");
+        return;
+    }
+    scanSave = save;
+    scanReported = 0;
+    scanFrom = millis();
+    radio.scanStart(bandmap_data(), 0, BANDMAP_CHANNELS, state.freq);
+    sched_every(&scanTask, scan_task, SCAN_MS);
+    uart_puts_P("ok\n");
+}
+
+// Same as the chord; only a front panel button wakes the radio again
+static void cmd_standby(uint8_t argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    if (inStandby) {
+        uart_puts_P("err standby\n");
+        return;
+    }
+    uart_puts_P("ok\n");
+    standby_enter();
+}
 
+// Raw group as received, RDS is not decoded yet
+static void cmd_rds(uint8_t argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    if (!tuner_ready()) return;
+    if (radio.busy()) {
+        uart_puts_P("err busy\n");
+        return;
+    }
+
+    uint16_t blocks[4];
+    uint8_t errors;
+    char buffer[6];
+    if (!radio.getRDSGroup(blocks, errors)) {
+        uart_puts_P("rds none\n");
+        return;
+    }
+    uart_puts_P("rds");
+    for (uint8_t i = 0; i < 4; i++) {
+        uart_putc(' ');
+        uart_puts(utoa(blocks[i], buffer, 16));
+    }
+    uart_put_uint(" bler ", errors, "\n");
+}
+
+// Prints one stats line per run while the transmit buffer has room
+static void stats_list_task()
+{
+    static uint8_t line;
+
+    if (!sched_active(&listTask)) {     // called by the command
+        line = 0;
+        sched_every(&listTask, stats_list_task, SHELL_MS);
+    }
+
+    while (line < 3 && uart_tx_free() >= 60) {
+        if (line == 0) print_stats();
+        if (line == 1) print_uart_stats();
+        if (line == 2) print_map_stats();
+        line++;
+    }
+    if (line >= 3) sched_cancel(&listTask);
+}
+
+static void cmd_stats(uint8_t argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    if (sched_active(&listTask)) uart_puts_P("err busy\n");
+    else stats_list_task();
+}
+
+static void cmd_tlm(uint8_t argc, char *argv[])
+{
+    bool on = argc > 1 && strcmp(argv[1], "on") == 0;
+    if (argc < 2 || (!on && strcmp(argv[1], "off") != 0)) {
+        uart_puts_P("err tlm on|off\n");
+        return;
+    }
+    // answer at the old rate, the host switches after the reply
+    uart_put_uint("ok ", on ? TELEMETRY_BAUD / 100 : CONSOLE_BAUD / 100, "00 Bd\n");
+    telemetryOn = on;
+    if (!on) {
+        telemetry_enable(0);
+        sched_cancel(&telemetryTask);
+    }
+    baud_switch();
+}
+
+static void cmd_help(uint8_t argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    shell_help();
+}
+
+static const shell_cmd_t commands[] PROGMEM = {
+    { "tune",   cmd_tune },
+    { "seek",   cmd_seek },
+    { "vol",    cmd_vol },
+    { "mute",   cmd_mute },
+    { "preset", cmd_preset },
+    { "scan",   cmd_scan },
+    { "rds",    cmd_rds },
+    { "standby", cmd_standby },
+    { "stats",  cmd_stats },
+    { "tlm",    cmd_tlm },
+    { "help",   cmd_help },
+};
+
+static void shell_task()
+{
+    shell_poll();
+}
+
+
+int main() {
+#ifdef FREQ_ENCODER
+    input_init(INPUT_VOL_UP | INPUT_VOL_DOWN);  // PD5/PD6 belong to the encoder
+#else
+    input_init(INPUT_ALL);
+#endif
+    systick_init();
+    uart_init(UART_BAUD_SELECT(CONSOLE_BAUD, F_CPU));
+    pcint_init();
+    sei();
+
+    // Si4703 into reset with SDIO low (2-wire mode); the boot chain
+    // continues from the scheduler
+    radio.bootReset();
+    sched_after(&bootTask, boot_release, 1);
+
+    presets_init();  // factory set on first boot
+    journal_init(&state, freqSelector.count());  // last station, keeps the defaults if none
+    LOG_INFO("Starting Si4703 FM Radio Receiver...");
+
+    // Resume where the radio was switched off
+#ifdef FREQ_ENCODER
+    freqSelector.select((state.freq - 8750) / 10);
+#else
+    freqSelector.select(state.preset);
+#endif
+    lastFreq = freqSelector.get();  // the radio task must not retune to the preset
+    FreqSelector::attach(&freqSelector);
+
+    oled.setRdsText("HELLO FROM RADIO STREAMING SERVICE");
+    oled.setFrequency(state.freq);
+    oled.setVolume(state.volume);
+
+    sched_every(&panelTask, panel_task, PANEL_MS);
+    sched_every(&radioTask, radio_task, RADIO_MS);
+    sched_every(&signalTask, signal_task, SIGNAL_MS);
+    sched_every(&journalTask, journal_task, JOURNAL_MS);
+    sched_every(&statsTask, stats_task, STATS_MS);
+    sched_every(&refreshTask, refresh_task, REFRESH_MS);
+    shell_init(commands, sizeof(commands) / sizeof(commands[0]));
+    telemetry_set_rate(TLM_SIGNAL, 100);
+    telemetry_set_rate(TLM_RDS, 0);     // every new group
+    telemetry_set_rate(TLM_TWI, 1000);
+    telemetry_set_rate(TLM_LOOP, 1000);
+    sched_every(&shellTask, shell_task, SHELL_MS);
+
+    // Run what is due, then format one log message if nothing else is,
+    // else idle sleep until the next interrupt. Nothing but the tick
+    // makes a task due, so the CPU wakes at most 1 ms late.
+    while (1) {
+        sched_run();
+        if (sched_idle_ms() && log_drain()) continue;
+        cli();
+        if (sched_idle_ms()) power_idle();
+        else sei();
     }
 
     return 0;
-}
\ No newline at end of file
+}
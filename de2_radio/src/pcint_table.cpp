@@ -0,0 +1,42 @@
+/*
+ * Pin change interrupt handlers of the front panel.
+ *
+ * Estimated cost at 16 MHz (from the generated instruction sequence):
+ *   PCINT0: ~35 cycles (2.2 us), wake flag only
+ *   PCINT2: ~110 cycles (6.9 us) with an encoder step, ~40 cycles otherwise
+ * Latency is the AVR's 4 cycles plus the longest interrupts-off section:
+ * the input tick (Timer2, ~250 cycles worst case) or a UART ISR.
+ */
+
+#include <pcint.h>
+#include "freqselector.h"
+#include "input.h"
+#include "power.h"
+
+// PORTB: VOL+ on PB0
+typedef PcintTable<
+    PcintHandler<INPUT_VOL_UP, power_pin_change>
+> PortBTable;
+
+// PORTC: TWI and tuner only, nothing to dispatch
+typedef PcintTable<> PortCTable;
+
+// PORTD: PREV/NEXT (or the encoder) and VOL- on PD5..PD7
+typedef PcintTable<
+    PcintHandler<FreqPinA::mask | FreqPinB::mask, FreqSelector::pinChange>,
+    PcintHandler<INPUT_ALL & 0xE0, power_pin_change>
+> PortDTable;
+
+PCINT_VECTOR(PCINT0_vect, PortB, PortBTable)
+PCINT_VECTOR(PCINT1_vect, PortC, PortCTable)
+PCINT_VECTOR(PCINT2_vect, PortD, PortDTable)
+
+void pcint_init()
+{
+#ifdef PCINT_PROFILE
+    PcintProfilePin::output();
+#endif
+    PcintPort<PortB, PortBTable>::sync();
+    PcintPort<PortC, PortCTable>::sync();
+    PcintPort<PortD, PortDTable>::sync();
+}
@@ -0,0 +1,206 @@
+/*
+ * Host tests of Ring<T, N> (lib/ring/ring.h).
+ *
+ *   pio test -e native -f test_ring
+ *
+ * The ISR side is simulated by interleaving random producer and consumer
+ * calls against a reference queue; a second test hands a sequence over
+ * between two threads.
+ */
+
+// -- Includes -------------------------------------------------------
+#include <unity.h>
+#include <ring.h>
+#include <deque>
+#include <thread>
+
+
+// -- Defines --------------------------------------------------------
+#define INTERLEAVINGS   2000000UL       // random calls of either side
+#define THREAD_ITEMS    1000000UL       // items through the threaded ring
+
+
+// -- Local functions ------------------------------------------------
+static uint32_t seed = 1;
+
+/* xorshift32, the same sequence on every run */
+static uint32_t rnd(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+
+// -- Tests ----------------------------------------------------------
+void setUp(void)
+{
+    seed = 1;
+}
+
+void tearDown(void)
+{
+}
+
+
+/* An empty ring takes exactly N items, gives them back in order, and
+ * keeps doing so when the free-running indices wrap past 255 */
+void test_capacity_and_wrap(void)
+{
+    static Ring<uint8_t, 16> ring;
+    uint8_t item;
+
+    for (int round = 0; round < 40; round++) {
+        for (uint8_t i = 0; i < 16; i++) {
+            TEST_ASSERT_TRUE(ring.push((uint8_t)(round + i)));
+        }
+        TEST_ASSERT_TRUE(ring.full());
+        TEST_ASSERT_EQUAL_UINT8(0, ring.space());
+        TEST_ASSERT_FALSE(ring.push(0));
+
+        TEST_ASSERT_TRUE(ring.peek(item));
+        TEST_ASSERT_EQUAL_UINT8(round, item);
+        for (uint8_t i = 0; i < 16; i++) {
+            TEST_ASSERT_TRUE(ring.pop(item));
+            TEST_ASSERT_EQUAL_UINT8((uint8_t)(round + i), item);
+        }
+        TEST_ASSERT_TRUE(ring.empty());
+        TEST_ASSERT_FALSE(ring.pop(item));
+    }
+}
+
+
+/* Random single and bulk calls of both sides, as an ISR would cut into
+ * the main loop; the ring must match the reference queue after each */
+void test_interleavings(void)
+{
+    static Ring<uint16_t, 32> ring;
+    std::deque<uint16_t> model;
+    uint16_t next = 0;
+    uint16_t items[40];
+    uint16_t item;
+
+    for (uint32_t step = 0; step < INTERLEAVINGS; step++) {
+        uint32_t r = rnd();
+        uint8_t n = (uint8_t)((r >> 8) % 40);
+
+        switch (r & 7) {
+        case 0:
+        case 1:                         // producer, one item
+            if (ring.push(next)) {
+                TEST_ASSERT_TRUE(model.size() < 32);
+                model.push_back(next++);
+            } else {
+                TEST_ASSERT_EQUAL_UINT32(32, model.size());
+            }
+            break;
+        case 2: {                       // producer, bulk
+            for (uint8_t i = 0; i < n; i++) items[i] = (uint16_t)(next + i);
+            uint8_t pushed = ring.push(items, n);
+            uint8_t expect = (uint8_t)(32 - model.size());
+            if (n < expect) expect = n;
+            TEST_ASSERT_EQUAL_UINT8(expect, pushed);
+            for (uint8_t i = 0; i < pushed; i++) model.push_back(next++);
+            break;
+        }
+        case 3:
+        case 4:                         // consumer, one item
+            if (ring.pop(item)) {
+                TEST_ASSERT_FALSE(model.empty());
+                TEST_ASSERT_EQUAL_UINT16(model.front(), item);
+                model.pop_front();
+            } else {
+                TEST_ASSERT_TRUE(model.empty());
+            }
+            break;
+        case 5: {                       // consumer, bulk
+            uint8_t popped = ring.pop(items, n);
+            uint8_t expect = (uint8_t)model.size();
+            if (n < expect) expect = n;
+            TEST_ASSERT_EQUAL_UINT8(expect, popped);
+            for (uint8_t i = 0; i < popped; i++) {
+                TEST_ASSERT_EQUAL_UINT16(model.front(), items[i]);
+                model.pop_front();
+            }
+            break;
+        }
+        case 6:                         // consumer, peek
+            if (ring.peek(item)) {
+                TEST_ASSERT_EQUAL_UINT16(model.front(), item);
+            } else {
+                TEST_ASSERT_TRUE(model.empty());
+            }
+            break;
+        default: {                      // consumer, discard
+            uint8_t dropped = ring.discard(n & 7);
+            uint8_t expect = (uint8_t)model.size();
+            if ((n & 7) < expect) expect = n & 7;
+            TEST_ASSERT_EQUAL_UINT8(expect, dropped);
+            model.erase(model.begin(), model.begin() + dropped);
+            break;
+        }
+        }
+        TEST_ASSERT_EQUAL_UINT32(model.size(), ring.count());
+        TEST_ASSERT_EQUAL_UINT8(32 - model.size(), ring.space());
+    }
+}
+
+
+/* One producer and one consumer thread; every item must arrive once and
+ * in order. The ring orders its accesses for the compiler only, which is
+ * enough on the AVR and on x86 (stores are not reordered) but not on
+ * weakly ordered hosts */
+void test_two_threads(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    static Ring<uint32_t, 64> ring;
+    uint32_t errors = 0;
+
+    std::thread producer([] {
+        uint32_t items[8];
+        uint32_t next = 0;
+        while (next < THREAD_ITEMS) {
+            if (ring.full()) {
+                std::this_thread::yield();
+            } else if (next & 1) {
+                if (ring.push(next)) next++;
+            } else {
+                uint8_t n = 0;
+                while (n < 8 && next + n < THREAD_ITEMS) {
+                    items[n] = next + n;
+                    n++;
+                }
+                next += ring.push(items, n);
+            }
+        }
+    });
+
+    uint32_t items[8];
+    uint32_t expect = 0;
+    while (expect < THREAD_ITEMS) {
+        uint8_t n = ring.pop(items, (uint8_t)(1 + (expect & 7)));
+        if (n == 0) std::this_thread::yield();
+        for (uint8_t i = 0; i < n; i++) {
+            if (items[i] != expect) errors++;
+            expect++;
+        }
+    }
+    producer.join();
+
+    TEST_ASSERT_EQUAL_UINT32(0, errors);
+    TEST_ASSERT_TRUE(ring.empty());
+#else
+    TEST_IGNORE_MESSAGE("needs a host with ordered stores");
+#endif
+}
+
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_capacity_and_wrap);
+    RUN_TEST(test_interleavings);
+    RUN_TEST(test_two_threads);
+    return UNITY_END();
+}
@@ -0,0 +1,242 @@
+/*
+ * Host tests of the scheduler (lib/scheduler) on the virtual clock of the
+ * native HAL: Timer2 ticks millis() as on the AVR while the test moves
+ * time on.
+ *
+ *   pio test -e native -f test_scheduler
+ *
+ * Random starts, restarts and cancels check that every task runs at its
+ * exact due time while the loop sleeps for sched_idle_ms() as main does;
+ * the benchmark times sched_run() per tick with 0, 8 and 32 timers.
+ */
+
+// -- Includes -------------------------------------------------------
+#include <unity.h>
+#include <avr/interrupt.h>
+#include <hal.h>
+#include <scheduler.h>
+#include <systick.h>
+#include <chrono>
+#include <stdio.h>
+
+
+// -- Defines --------------------------------------------------------
+#define TASKS           40
+#define RANDOM_MS       400000UL        // virtual run time of the random test
+#define BENCH_TICKS     200000UL        // ticks per benchmark run
+#define MAX_DELAY       32767
+
+
+// -- Local variables ------------------------------------------------
+/* What the scheduler should do with each task */
+typedef struct {
+    uint8_t active;
+    uint16_t period;
+    uint32_t base;                      // phase of a periodic task
+    uint32_t due;                       // millis() of the next run
+} model_t;
+
+static sched_task_t tasks[TASKS];
+static model_t model[TASKS];
+static uint32_t runs;
+static uint32_t seed = 1;
+
+
+// -- Local functions ------------------------------------------------
+/* xorshift32, the same sequence on every run */
+static uint32_t rnd(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+
+/* Let ms of virtual time pass, the tick interrupt runs in between */
+static void pass_ms(uint32_t ms)
+{
+    hal_native_advance((uint64_t)ms * (F_CPU / 1000));
+}
+
+
+static uint16_t random_delay(void)
+{
+    // mostly short timeouts, some up to the limit to exercise the cascade
+    switch (rnd() & 3) {
+    case 0:  return rnd() % 16;
+    case 1:  return rnd() % 256;
+    case 2:  return rnd() % 4096;
+    default: return rnd() % (MAX_DELAY + 1);
+    }
+}
+
+
+static void start(uint8_t i, uint8_t periodic);
+
+/* The task ran: it must be due now, then maybe restarts itself */
+static void on_run(uint8_t i)
+{
+    uint32_t now = millis();
+    model_t *m = &model[i];
+
+    runs++;
+    TEST_ASSERT_TRUE(m->active);
+    TEST_ASSERT_EQUAL_UINT32(m->due, now);
+
+    if (m->period) {
+        m->base += m->period;
+        if (m->base <= now) m->base = now + m->period;
+        m->due = m->base;
+    } else {
+        m->active = 0;
+    }
+
+    if ((rnd() & 7) == 0) start(i, rnd() & 1);
+}
+
+template <uint8_t I> static void task_fn(void) { on_run(I); }
+
+template <uint8_t... I> struct fn_table {
+    static constexpr sched_fn_t fns[sizeof...(I)] = {task_fn<I>...};
+};
+template <uint8_t N, uint8_t... I> struct make_fns : make_fns<N - 1, N - 1, I...> {};
+template <uint8_t... I> struct make_fns<0, I...> : fn_table<I...> {};
+
+static const sched_fn_t *fns = make_fns<TASKS>::fns;
+
+
+/* Start or restart a task from now; one started without a delay runs on
+ * the next sched_run(), which is the next tick of the test loop */
+static void start(uint8_t i, uint8_t periodic)
+{
+    uint32_t now = millis();
+    model_t *m = &model[i];
+
+    if (periodic) {
+        m->period = 1 + rnd() % 2000;
+        sched_every(&tasks[i], fns[i], m->period);
+        m->base = now;
+        m->due = now + 1;
+    } else {
+        uint16_t delay = random_delay();
+        m->period = 0;
+        sched_after(&tasks[i], fns[i], delay);
+        m->due = now + (delay ? delay : 1);
+    }
+    m->active = 1;
+}
+
+
+static void noop(void)
+{
+}
+
+
+// -- Tests ----------------------------------------------------------
+void setUp(void)
+{
+    seed = 1;
+    runs = 0;
+}
+
+void tearDown(void)
+{
+    for (uint8_t i = 0; i < TASKS; i++) {
+        sched_cancel(&tasks[i]);
+        model[i].active = 0;
+    }
+}
+
+
+/* Random start, restart and cancel of 40 tasks with delays up to 32767
+ * ms, over several wraps of the 16-bit wheel time. The loop jumps ahead
+ * by up to sched_idle_ms(), as main sleeps: if that ever overshot a due
+ * task, the task would run late */
+void test_exact_due_times(void)
+{
+    uint32_t end = millis() + RANDOM_MS;
+
+    while ((int32_t)(millis() - end) < 0) {
+        sched_run();
+
+        for (uint8_t n = rnd() % 3; n; n--) {
+            uint8_t i = rnd() % TASKS;
+            if ((rnd() & 3) == 0) {
+                sched_cancel(&tasks[i]);
+                model[i].active = 0;
+            } else {
+                start(i, (rnd() & 3) == 0);
+            }
+        }
+
+        uint32_t now = millis();
+        uint16_t idle = sched_idle_ms();
+        uint32_t next = 0xffffffffUL;
+        for (uint8_t i = 0; i < TASKS; i++) {
+            TEST_ASSERT_EQUAL_UINT8(model[i].active, sched_active(&tasks[i]));
+            if (model[i].active && model[i].due - now < next) next = model[i].due - now;
+        }
+        if (idle == 0xffff) {
+            TEST_ASSERT_EQUAL_UINT32(0xffffffffUL, next);
+        } else {
+            TEST_ASSERT_TRUE(idle <= next);
+        }
+
+        uint32_t step = (idle == 0 || idle == 0xffff) ? 1 : 1 + rnd() % idle;
+        pass_ms(step);
+    }
+
+    TEST_ASSERT_TRUE(runs > 10000);
+}
+
+
+/* sched_run() per tick, with 0, 8 and 32 periodic timers pending; the
+ * cost must not grow with their number */
+void test_tick_cost(void)
+{
+    static const uint8_t counts[] = {0, 8, 32};
+    using clock = std::chrono::steady_clock;
+    char msg[80];
+
+    for (uint8_t c = 0; c < sizeof(counts); c++) {
+        for (uint8_t i = 0; i < counts[c]; i++) {
+            sched_every(&tasks[i], noop, 1000 + rnd() % (MAX_DELAY - 1000));
+        }
+        sched_run();
+
+        clock::duration total = clock::duration::zero();
+        for (uint32_t t = 0; t < BENCH_TICKS; t++) {
+            pass_ms(1);
+            clock::time_point t0 = clock::now();
+            sched_run();
+            total += clock::now() - t0;
+        }
+
+        // the same pair of clock reads around nothing
+        clock::duration empty = clock::duration::zero();
+        for (uint32_t t = 0; t < BENCH_TICKS; t++) {
+            clock::time_point t0 = clock::now();
+            empty += clock::now() - t0;
+        }
+
+        long ns = (long)(std::chrono::duration_cast<std::chrono::nanoseconds>(total - empty).count()
+                         / (long)BENCH_TICKS);
+        snprintf(msg, sizeof(msg), "%u timers: %ld ns per tick", counts[c], ns);
+        TEST_MESSAGE(msg);
+
+        for (uint8_t i = 0; i < counts[c]; i++) sched_cancel(&tasks[i]);
+    }
+}
+
+
+int main(void)
+{
+    systick_init();
+    sei();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_exact_due_times);
+    RUN_TEST(test_tick_cost);
+    return UNITY_END();
+}
@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+"""
+bmp2rle.py - convert 1bpp images to the page-major RLE format of oled.c
+
+Usage:
+    python3 tools/bmp2rle.py [-o out.h] image.pbm [image2.png ...]
+
+Reads PBM (P1/P4) directly, any other format (PNG, BMP, ...) through Pillow
+when it is installed. Dark/set pixels become lit OLED pixels.
+
+Stream layout (decoded by oled_drawBitmap_rle()):
+    byte 0      width in pixels (1..128)
+    byte 1      height in display lines (pages of 8 rows)
+    then tokens, covering width*lines bytes in page-major order
+    (line 0 columns 0..width-1, line 1, ...), bit 0 = top row of a line:
+    0nnnnnnn            n+1 literal bytes follow (1..128)
+    10nnnnnn            n+1 bytes of 0x00 (1..64)
+    11nnnnnn vv         n+1 bytes of vv (1..64)
+
+A summary with flash bytes per image is printed to stderr.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+
+def read_pbm(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    # strip comments, split header tokens
+    tokens = []
+    pos = 0
+    magic = data[0:2]
+    pos = 2
+    while len(tokens) < 2:
+        m = re.compile(rb"\s*(#[^\n]*\n\s*)*(\d+)").match(data, pos)
+        if not m:
+            raise ValueError("%s: bad PBM header" % path)
+        tokens.append(int(m.group(2)))
+        pos = m.end()
+    width, height = tokens
+    pixels = []
+    if magic == b"P1":
+        bits = re.findall(rb"[01]", re.sub(rb"#[^\n]*", b"", data[pos:]))
+        bits = [b == b"1" for b in bits]
+        for y in range(height):
+            pixels.append(bits[y * width:(y + 1) * width])
+    elif magic == b"P4":
+        pos += 1  # single whitespace after header
+        stride = (width + 7) // 8
+        for y in range(height):
+            row = data[pos + y * stride:pos + (y + 1) * stride]
+            pixels.append([bool(row[x // 8] & (0x80 >> (x % 8))) for x in range(width)])
+    else:
+        raise ValueError("%s: only P1/P4 PBM is supported natively" % path)
+    return width, height, pixels
+
+
+def read_image(path):
+    if path.lower().endswith(".pbm"):
+        return read_pbm(path)
+    try:
+        from PIL import Image
+    except ImportError:
+        sys.exit("%s: Pillow is needed for non-PBM images" % path)
+    img = Image.open(path).convert("L")
+    width, height = img.size
+    pixels = [[img.getpixel((x, y)) < 128 for x in range(width)] for y in range(height)]
+    return width, height, pixels
+
+
+def to_pages(width, height, pixels):
+    lines = (height + 7) // 8
+    out = []
+    for line in range(lines):
+        for x in range(width):
+            b = 0
+            for bit in range(8):
+                y = line * 8 + bit
+                if y < height and pixels[y][x]:
+                    b |= 1 << bit
+            out.append(b)
+    return lines, out
+
+
+def encode(raw):
+    tokens = []
+    i = 0
+    literal = []
+
+    def flush():
+        while literal:
+            chunk = literal[:128]
+            del literal[:128]
+            tokens.append([len(chunk) - 1] + chunk)
+
+    while i < len(raw):
+        run = 1
+        while i + run < len(raw) and raw[i + run] == raw[i] and run < 64:
+            run += 1
+        # a run pays off from 2 bytes for 0x00, from 3 bytes otherwise
+        if (raw[i] == 0x00 and run >= 2) or run >= 3:
+            flush()
+            if raw[i] == 0x00:
+                tokens.append([0x80 | (run - 1)])
+            else:
+                tokens.append([0xC0 | (run - 1), raw[i]])
+            i += run
+        else:
+            literal.append(raw[i])
+            i += 1
+    flush()
+    return tokens
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    ap.add_argument("images", nargs="+")
+    ap.add_argument("-o", "--output", help="header to write (default: stdout)")
+    args = ap.parse_args()
+
+    guard = os.path.basename(args.output or "rle_bitmaps.h").replace(".", "_").upper()
+    out = []
+    out.append("/*")
+    out.append(" *  Generated by tools/bmp2rle.py - do not edit, regenerate instead.")
+    out.append(" *  Format: see oled_drawBitmap_rle() in oled.c")
+    out.append(" */")
+    out.append("#ifndef %s" % guard)
+    out.append("# define %s" % guard)
+    out.append("# include <avr/pgmspace.h>")
+    out.append("")
+    total = 0
+    for path in args.images:
+        width, height, pixels = read_image(path)
+        if width > 128:
+            sys.exit("%s: wider than the display" % path)
+        lines, raw = to_pages(width, height, pixels)
+        tokens = encode(raw)
+        stream = [width, lines] + [b for t in tokens for b in t]
+        name = re.sub(r"\W", "_", os.path.splitext(os.path.basename(path))[0])
+        out.append("// %dx%d, %d bytes (raw %d), %d tokens" %
+                   (width, lines * 8, len(stream), len(raw), len(tokens)))
+        out.append("const uint8_t rle_%s[] PROGMEM = {" % name)
+        for k in range(0, len(stream), 16):
+            out.append("    " + ", ".join("0x%02X" % b for b in stream[k:k + 16]) + ",")
+        out.append("};")
+        out.append("")
+        total += len(stream)
+        sys.stderr.write("%-20s %3dx%-3d %5d bytes (raw %5d) %4d tokens\n" %
+                         (name, width, lines * 8, len(stream), len(raw), len(tokens)))
+    out.append("#endif")
+    sys.stderr.write("%-20s %15d bytes flash\n" % ("total", total))
+
+    text = "\n".join(out) + "\n"
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+
+if __name__ == "__main__":
+    main()
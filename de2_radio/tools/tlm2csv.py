@@ -0,0 +1,215 @@
+#!/usr/bin/env python3
+"""
+tlm2csv.py - decode the binary telemetry stream of the radio into CSV
+
+Usage:
+    python3 tools/tlm2csv.py [-o DIR] capture.bin
+    python3 tools/tlm2csv.py [-o DIR] --port /dev/ttyUSB0 [--baud 500000]
+    python3 tools/tlm2csv.py --elf .pio/build/uno/firmware.elf capture.bin
+
+Switch the radio to telemetry first: send "tlm on" at 9600 Bd, then
+reopen the port at 500000 Bd ("tlm off" switches back). Reading a port
+needs pyserial; stop with Ctrl+C.
+
+Frames are COBS encoded between 0x00 delimiters (see lib/telemetry):
+    type u8 | millis u32 | payload | CRC-16/XMODEM u16, little endian
+Text lines and damaged frames in between are skipped and counted.
+
+One CSV file per record type is written to DIR (default: current dir):
+    signal.csv  t_ms, rssi, stereo, rds_sync, afc_rail, channel, freq_10khz
+    rds.csv     t_ms, a, b, c, d, bler_a, bler_b, bler_c, bler_d
+    twi.csv     t_ms, starts, bytes, nacks
+    loop.csv    t_ms, worst_task_us, worst_tick_us, load_pct, dropped
+    log.csv     t_ms, id, level, a, b, text
+
+A log record carries the time it was queued and the flash address of
+its format string (see lib/log) instead of text. With --elf the string is
+read from the firmware the capture was taken with and formatted; without
+it, text stays empty.
+"""
+
+import argparse
+import csv
+import os
+import re
+import struct
+import sys
+
+BAND_START = 8750   # 10 kHz units, channel 0
+SPACING = 10        # 100 kHz
+
+RECORDS = {
+    1: ("signal", "<BBH",
+        ["rssi", "stereo", "rds_sync", "afc_rail", "channel", "freq_10khz"]),
+    2: ("rds", "<HHHHB",
+        ["a", "b", "c", "d", "bler_a", "bler_b", "bler_c", "bler_d"]),
+    3: ("twi", "<HHH", ["starts", "bytes", "nacks"]),
+    4: ("loop", "<IIBH",
+        ["worst_task_us", "worst_tick_us", "load_pct", "dropped"]),
+    5: ("log", "<HBHHH", ["id", "level", "a", "b", "text"]),
+}
+
+LEVELS = {1: "E", 2: "W", 3: "I", 4: "D"}
+CONVERSION = re.compile(r"%[-+ #0]*\d*(?:\.\d+)?l?([diuxXc%])")
+
+
+def crc_xmodem(data):
+    crc = 0
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def decode(frame, formats=None):
+    """Return (type, t_ms, fields) or None for anything that is not a record."""
+    rec = cobs_decode(frame)
+    if rec is None or len(rec) < 7:
+        return None
+    body, crc = rec[:-2], struct.unpack("<H", rec[-2:])[0]
+    if crc_xmodem(body) != crc or body[0] not in RECORDS:
+        return None
+    kind = body[0]
+    t_ms = struct.unpack("<I", body[1:5])[0]
+    fmt = RECORDS[kind][1]
+    if len(body) - 5 != struct.calcsize(fmt):
+        return None
+    v = struct.unpack(fmt, body[5:])
+    if kind == 1:
+        rssi, flags, chan = v
+        fields = [rssi, flags & 1, flags >> 1 & 1, flags >> 2 & 1, chan,
+                  BAND_START + chan * SPACING]
+    elif kind == 2:
+        a, b, c, d, bler = v
+        fields = ["%04x" % a, "%04x" % b, "%04x" % c, "%04x" % d,
+                  bler >> 6, bler >> 4 & 3, bler >> 2 & 3, bler & 3]
+    elif kind == 5:
+        fmt_id, level, queued, a, b = v
+        t_ms -= (t_ms - queued) & 0xFFFF    # queued, not sent
+        fields = ["%04x" % fmt_id, LEVELS.get(level, level), a, b,
+                  formats.text(fmt_id, a, b) if formats else ""]
+    else:
+        fields = list(v)
+    return kind, t_ms, fields
+
+
+class Formats:
+    """Format strings of a firmware ELF, looked up by flash address."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.image = f.read()
+        if self.image[:4] != b"\x7fELF" or self.image[4] != 1:
+            raise ValueError("%s: not a 32 bit ELF file" % path)
+        shoff, = struct.unpack_from("<I", self.image, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", self.image, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            _, kind, flags, addr, offset, size = struct.unpack_from(
+                "<IIIIII", self.image, shoff + i * shentsize)
+            if kind == 1 and flags & 2:     # PROGBITS, ALLOC
+                self.sections.append((addr, offset, size))
+
+    def text(self, address, a, b):
+        for addr, offset, size in self.sections:
+            if addr <= address < addr + size:
+                start = offset + address - addr
+                end = self.image.index(b"\x00", start)
+                fmt = self.image[start:end].decode("latin-1")
+                return self.format(fmt, [a, b])
+        return "?%04x" % address
+
+    @staticmethod
+    def format(fmt, args):
+        def conv(m):
+            kind = m.group(1)
+            if kind == "%":
+                return "%"
+            v = args.pop(0) if args else 0
+            if kind in "di" and v >= 0x8000:
+                v -= 0x10000
+            spec = m.group(0)[:-1].replace("l", "")
+            return (spec + ("d" if kind in "diu" else kind)) % v
+        return CONVERSION.sub(conv, fmt)
+
+
+def chunks(args):
+    if args.port:
+        import serial  # pyserial, only needed for live capture
+        with serial.Serial(args.port, args.baud, timeout=0.2) as port:
+            while True:
+                yield port.read(4096)
+    else:
+        with open(args.capture, "rb") as f:
+            while True:
+                data = f.read(65536)
+                if not data:
+                    return
+                yield data
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    ap.add_argument("capture", nargs="?", help="raw capture file")
+    ap.add_argument("--port", help="serial port to read instead of a file")
+    ap.add_argument("--baud", type=int, default=500000)
+    ap.add_argument("-o", "--output", default=".", help="directory for the CSV files")
+    ap.add_argument("--elf", help="firmware ELF to resolve log formats from")
+    args = ap.parse_args()
+    if not args.capture and not args.port:
+        ap.error("give a capture file or --port")
+    formats = Formats(args.elf) if args.elf else None
+
+    os.makedirs(args.output, exist_ok=True)
+    files, writers = {}, {}
+    for kind, (name, _, columns) in RECORDS.items():
+        files[kind] = open(os.path.join(args.output, name + ".csv"), "w", newline="")
+        writers[kind] = csv.writer(files[kind])
+        writers[kind].writerow(["t_ms"] + columns)
+
+    counts = {kind: 0 for kind in RECORDS}
+    skipped = 0
+    pending = bytearray()
+    try:
+        for data in chunks(args):
+            pending += data
+            *frames, pending = pending.split(b"\x00")
+            pending = bytearray(pending)
+            for frame in frames:
+                if not frame:
+                    continue
+                rec = decode(frame, formats)
+                if rec is None:
+                    skipped += 1
+                    continue
+                kind, t_ms, fields = rec
+                writers[kind].writerow([t_ms] + fields)
+                counts[kind] += 1
+    except KeyboardInterrupt:
+        pass
+    finally:
+        for f in files.values():
+            f.close()
+
+    summary = ", ".join("%s %d" % (RECORDS[k][0], n) for k, n in counts.items())
+    sys.stderr.write("%s, skipped %d\n" % (summary, skipped))
+
+
+if __name__ == "__main__":
+    main()